@@ -32,7 +32,8 @@ ConstellationProperties::ConstellationProperties(int c)
 	id=c;
 	svcnt=0;
 	x0=0;
-	active=false;
+	setActive(false);
+	timeout=TRACKING_TIMEOUT;
 	switch(id){
 		case GNSSSV::Beidou:
 			maxsv=12;
@@ -26,10 +26,11 @@
 #ifndef __CONSTELLATION_PROPERTIES_H_
 #define __CONSTELLATION_PROPERTIES_H_
 
+#include <QAtomicInt>
 #include <QGLWidget>
 #include <QString>
 
-class GLText;
+#define TRACKING_TIMEOUT 120 // default, in seconds
 
 class ConstellationProperties{
 	public:
@@ -38,13 +39,17 @@ class ConstellationProperties{
 		int svcnt;
 		int maxsv;
 		double x0;
-		bool active;
+		bool isActive() const {return active.loadAcquire();}
+		void setActive(bool a){active.storeRelease(a);}
+		int timeout; // a satellite not updated for this long (in seconds) is dropped
 		GLfloat histColour[4];
 		QString label;
-		GLText *GLlabel;
 		int svIDmin,svIDmax;
 		QString idLabel;
-		QList<GLText *> svLabels;
+		
+	private:
+	
+		QAtomicInt active; // read by the ingest thread's parsers
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <string.h>
+
+#include <QDebug>
+
+#include "DatagramDecoder.h"
+#include "DatagramParser.h"
+
+DatagramDecoder::DatagramDecoder(QList<ConstellationProperties *> &c,ObservationRing *r):StreamDecoder(c,r)
+{
+	parser = new DatagramParser(constellations);
+}
+
+DatagramDecoder::~DatagramDecoder()
+{
+	delete parser;
+}
+
+void DatagramDecoder::decode(const char *buf,int len)
+{
+	pending.append(buf,len);
+	
+	const char *p = pending.constData();
+	int n = pending.size();
+	int i=0;
+	
+	while (i < n){
+		if (DatagramParser::isBinary(p+i,n-i)){
+			if (n-i < BINARY_HEADER_SIZE) break;
+			int recsize = (unsigned char) p[i+3];
+			int nrecs = (unsigned char) p[i+12] | ((unsigned char) p[i+13] << 8);
+			if (p[i+2] != BINARY_VERSION || recsize < BINARY_RECORD_SIZE){ // not really a header so resync
+				i++;
+				nSkipped++;
+				continue;
+			}
+			int size = BINARY_HEADER_SIZE + nrecs*recsize;
+			if (n-i < size) break;
+			decodeDatagram(p+i,size);
+			i += size;
+		}
+		else{
+			const char *eol = (const char *) memchr(p+i,'\n',n-i);
+			if (!eol) break;
+			decodeDatagram(p+i,eol-(p+i)+1);
+			i = eol-p+1;
+		}
+	}
+	
+	if (n-i > DATAGRAM_MAX_PENDING){ // no end in sight, so it's garbage
+		nSkipped += n-i;
+		i=n;
+	}
+	pending.remove(0,i);
+}
+
+void DatagramDecoder::decodeDatagram(const char *buf,int len)
+{
+	nMessages++;
+	int pos=0;
+	while (pos < len){
+		int nobs = parser->parse(buf,len,observations,MAX_OBSERVATIONS,&pos);
+		if (nobs > 0)
+			publish(observations,nobs); // drops are counted by the ring
+	}
+}
@@ -0,0 +1,60 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __DATAGRAM_DECODER_H_
+#define __DATAGRAM_DECODER_H_
+
+#include <QByteArray>
+
+#include "Observation.h"
+#include "StreamDecoder.h"
+
+#define DATAGRAM_MAX_PENDING 65536
+
+class DatagramParser;
+
+// Decodes gnssview's own CSV and binary formats.
+// Datagrams are parsed as they are. On a stream (TCP, a file, a serial port)
+// the data is first split into CSV lines and binary messages.
+
+class DatagramDecoder : public StreamDecoder
+{
+	public:
+	
+		DatagramDecoder(QList<ConstellationProperties *> &,ObservationRing *);
+		~DatagramDecoder();
+		
+		virtual void decode(const char *,int);
+		virtual void decodeDatagram(const char *,int);
+		virtual QString name(){return "gnssview";}
+		
+	private:
+	
+		DatagramParser *parser;
+		QByteArray pending;
+		Observation observations[MAX_OBSERVATIONS];
+};
+
+#endif
@@ -0,0 +1,307 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <climits>
+#include <cmath>
+
+#include "ConstellationProperties.h"
+#include "DatagramParser.h"
+#include "GNSSSV.h"
+#include "Observation.h"
+
+#define NFIELDS 6
+
+// Powers of ten which are exactly representable as doubles
+static const double pow10tab[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+	1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+static inline bool isSpace(char c)
+{
+	return (c==' ' || c=='\t' || c=='\r' || c=='\n' || c=='\v' || c=='\f');
+}
+
+static inline bool isDigit(char c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+static inline void trim(const char **start,const char **end)
+{
+	while (*start < *end && isSpace(**start)) (*start)++;
+	while (*end > *start && isSpace(*(*end-1))) (*end)--;
+}
+
+// Little-endian fields of binary datagrams
+
+static inline unsigned int getU8(const char *p)
+{
+	return (unsigned char) p[0];
+}
+
+static inline unsigned int getU16(const char *p)
+{
+	return (unsigned char) p[0] | ((unsigned char) p[1] << 8);
+}
+
+static inline int getS16(const char *p)
+{
+	return (short) getU16(p);
+}
+
+static inline unsigned int getU32(const char *p)
+{
+	return getU16(p) | (getU16(p+2) << 16);
+}
+
+// The number conversions follow QString::toInt() and QString::toDouble():
+// surrounding whitespace is ignored and anything unparseable is an error.
+// Like the QString conversions, the caller gets 0 on error.
+
+static bool toInt(const char *p,const char *end,int *val)
+{
+	*val=0;
+	trim(&p,&end);
+	if (p==end) return false;
+	bool neg=false;
+	if (*p=='+' || *p=='-'){
+		neg = (*p=='-');
+		p++;
+	}
+	if (p==end) return false;
+	long long v=0;
+	while (p<end){
+		if (!isDigit(*p)) return false;
+		v = v*10 + (*p - '0');
+		if (v > (long long) INT_MAX + 1) return false;
+		p++;
+	}
+	if (neg) v=-v;
+	if (v > INT_MAX || v < INT_MIN) return false;
+	*val = (int) v;
+	return true;
+}
+
+static bool toDouble(const char *p,const char *end,double *val)
+{
+	*val=0.0;
+	trim(&p,&end);
+	if (p==end) return false;
+	bool neg=false;
+	if (*p=='+' || *p=='-'){
+		neg = (*p=='-');
+		p++;
+	}
+	
+	unsigned long long mant=0;
+	int exp10=0;
+	bool gotDigits=false;
+	
+	while (p<end && isDigit(*p)){
+		if (mant < 100000000000000000ULL) // 1e17, so we don't overflow
+			mant = mant*10 + (*p - '0');
+		else
+			exp10++;
+		gotDigits=true;
+		p++;
+	}
+	if (p<end && *p=='.'){
+		p++;
+		while (p<end && isDigit(*p)){
+			if (mant < 100000000000000000ULL){
+				mant = mant*10 + (*p - '0');
+				exp10--;
+			}
+			gotDigits=true;
+			p++;
+		}
+	}
+	if (!gotDigits) return false;
+	
+	if (p<end && (*p=='e' || *p=='E')){
+		p++;
+		bool eneg=false;
+		if (p<end && (*p=='+' || *p=='-')){
+			eneg = (*p=='-');
+			p++;
+		}
+		if (p==end || !isDigit(*p)) return false;
+		int e=0;
+		while (p<end && isDigit(*p)){
+			if (e < 10000) e = e*10 + (*p - '0');
+			p++;
+		}
+		exp10 += (eneg? -e : e);
+	}
+	if (p != end) return false;
+	
+	double v = (double) mant;
+	if (exp10 < 0){
+		if (exp10 >= -22)
+			v /= pow10tab[-exp10];
+		else
+			v /= pow(10.0,-exp10);
+	}
+	else if (exp10 > 0){
+		if (exp10 <= 22)
+			v *= pow10tab[exp10];
+		else
+			v *= pow(10.0,exp10);
+	}
+	*val = (neg ? -v : v);
+	return true;
+}
+
+DatagramParser::DatagramParser(QList<ConstellationProperties *> &c):constellations(c)
+{
+}
+
+int DatagramParser::parse(const QByteArray &datagram,Observation *obs,int maxobs,int *pos)
+{
+	return parse(datagram.constData(),datagram.size(),obs,maxobs,pos);
+}
+
+//	Parses up to maxobs observations from the datagram buf, returning the number parsed.
+//	If pos is not NULL, parsing starts at *pos and *pos is updated to where parsing stopped,
+//	so that the caller can resume parsing if the observation buffer filled up.
+//	Parsing is complete when *pos == len
+
+int DatagramParser::parse(const char *buf,int len,Observation *obs,int maxobs,int *pos)
+{
+	int start=0;
+	if (pos == NULL) pos = &start;
+	if (isBinary(buf,len))
+		return parseBinary(buf,len,obs,maxobs,pos);
+	return parseText(buf,len,obs,maxobs,pos);
+}
+
+bool DatagramParser::isBinary(const char *buf,int len)
+{
+	return (len >= 2 && buf[0] == BINARY_MAGIC0 && buf[1] == BINARY_MAGIC1);
+}
+
+//
+// Private
+//
+
+int DatagramParser::parseText(const char *buf,int len,Observation *obs,int maxobs,int *pos)
+{
+	int nobs=0;
+	const char *p = buf + *pos;
+	const char *end = buf+len;
+	
+	while (p < end && nobs < maxobs){
+		const char *eol=p;
+		while (eol < end && *eol != '\n' && *eol != '\0') eol++;
+		
+		if (parseLine(p,eol,&(obs[nobs])))
+			nobs++;
+		
+		if (eol == end || *eol == '\0'){ // a NUL is the end of the data, as it would be for QString
+			p = end;
+			break;
+		}
+		p = eol+1;
+	}
+	
+	*pos = p-buf;
+	return nobs;
+}
+
+int DatagramParser::parseBinary(const char *buf,int len,Observation *obs,int maxobs,int *pos)
+{
+	if (len < BINARY_HEADER_SIZE || getU8(buf+2) != BINARY_VERSION){
+		*pos=len; // nothing we can use
+		return 0;
+	}
+	
+	int recsize = getU8(buf+3);
+	int timestamp = getU32(buf+8);
+	int nrecs = getU16(buf+12);
+	if (recsize < BINARY_RECORD_SIZE || BINARY_HEADER_SIZE + nrecs*recsize > len){ // truncated or garbage
+		*pos=len;
+		return 0;
+	}
+	
+	int first = 0;
+	if (*pos > BINARY_HEADER_SIZE) // resuming
+		first = (*pos - BINARY_HEADER_SIZE)/recsize;
+	
+	int nobs=0;
+	int r;
+	for (r=first;r<nrecs && nobs < maxobs;r++){
+		const char *rec = buf + BINARY_HEADER_SIZE + r*recsize;
+		int c = getU8(rec);
+		int prn = getU8(rec+1);
+		if (!validate(c,prn)) continue;
+		Observation &o = obs[nobs++];
+		o.timestamp=timestamp;
+		o.constellation=c;
+		o.PRN=prn;
+		o.az = getU16(rec+2)/100.0;
+		o.elev = getS16(rec+4)/100.0;
+		o.sn = getU16(rec+6)/100.0;
+	}
+	
+	*pos = (r == nrecs ? len : BINARY_HEADER_SIZE + r*recsize);
+	return nobs;
+}
+
+bool DatagramParser::validate(int c,int prn)
+{
+	if (c<GNSSSV::Beidou || c > GNSSSV::SBAS) return false; // bad constellation identifier
+	ConstellationProperties *cprop = constellations.at(c);
+	if (!cprop->isActive()) return false;
+	return (prn >= cprop->svIDmin && prn <= cprop->svIDmax);
+}
+
+bool DatagramParser::parseLine(const char *start,const char *end,Observation *o)
+{
+	const char *fields[NFIELDS+1];
+	int nf=0;
+	
+	fields[nf++]=start;
+	for (const char *p=start;p<end;p++){
+		if (*p == ','){
+			if (nf == NFIELDS) return false; // too many fields
+			fields[nf++]=p+1;
+		}
+	}
+	if (nf != NFIELDS) return false;
+	fields[NFIELDS]=end+1; // so that fields[i+1]-1 is the end of every field
+	
+	int c,prn;
+	toInt(fields[1],fields[2]-1,&c);
+	toInt(fields[2],fields[3]-1,&prn);
+	if (!validate(c,prn)) return false;
+	
+	o->constellation=c;
+	o->PRN=prn;
+	toInt(fields[0],fields[1]-1,&(o->timestamp));
+	toDouble(fields[3],fields[4]-1,&(o->az));
+	toDouble(fields[4],fields[5]-1,&(o->elev));
+	toDouble(fields[5],fields[6]-1,&(o->sn));
+	
+	return true;
+}
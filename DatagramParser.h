@@ -0,0 +1,84 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __DATAGRAM_PARSER_H_
+#define __DATAGRAM_PARSER_H_
+
+#include <QByteArray>
+#include <QList>
+
+class ConstellationProperties;
+class Observation;
+
+// Binary datagrams, version 1. All fields are little-endian.
+// Header:
+//   magic          2 bytes  'G','V'
+//   version        uint8    1
+//   record size    uint8    8 (records may grow in later versions)
+//   sequence no.   uint32
+//   timestamp      uint32   UNIX time of the epoch
+//   record count   uint16
+//   reserved       uint16
+// followed by the records:
+//   constellation  uint8
+//   PRN            uint8
+//   azimuth        uint16   centidegrees
+//   elevation      int16    centidegrees
+//   signal level   uint16   hundredths
+
+#define BINARY_MAGIC0       'G'
+#define BINARY_MAGIC1       'V'
+#define BINARY_VERSION      1
+#define BINARY_HEADER_SIZE  16
+#define BINARY_RECORD_SIZE  8
+
+// Parses datagrams in place, without creating any intermediate strings.
+// Binary datagrams are recognised by their magic number; anything else
+// is treated as text of the form
+//   timestamp,constellation,prn,az,el,sn\n ...
+// Records which don't validate are silently dropped, as before.
+
+class DatagramParser
+{
+	public:
+	
+		DatagramParser(QList<ConstellationProperties *> &);
+		
+		int parse(const char *,int,Observation *,int,int *pos=NULL);
+		int parse(const QByteArray &,Observation *,int,int *pos=NULL);
+		
+		static bool isBinary(const char *,int);
+		
+	private:
+	
+		int  parseText(const char *,int,Observation *,int,int *);
+		int  parseBinary(const char *,int,Observation *,int,int *);
+		bool parseLine(const char *,const char *,Observation *);
+		bool validate(int,int);
+		
+		QList<ConstellationProperties *> &constellations;
+};
+
+#endif
@@ -0,0 +1,143 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include "DeviceSource.h"
+
+static speed_t toSpeed(int baud)
+{
+	switch (baud){
+		case 4800:   return B4800;
+		case 9600:   return B9600;
+		case 19200:  return B19200;
+		case 38400:  return B38400;
+		case 57600:  return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+#ifdef B460800
+		case 460800: return B460800;
+#endif
+#ifdef B921600
+		case 921600: return B921600;
+#endif
+	}
+	return B0;
+}
+
+DeviceSource::DeviceSource(QString p,int b,StreamDecoder *d,QObject *parent):
+	InputSource((p == "-" ? QString("stdin") : QString("device:%1").arg(p)),d,parent)
+{
+	path=p;
+	baud=b;
+	fd=-1;
+	notifier=NULL;
+}
+
+DeviceSource::~DeviceSource()
+{
+	closeDevice();
+}
+
+bool DeviceSource::open()
+{
+	if (path == "-"){ // left as it is, since it's shared with whoever started us
+		fd = dup(STDIN_FILENO);
+		if (fd < 0){
+			qWarning() << "Can't use stdin: " << strerror(errno);
+			return false;
+		}
+	}
+	else{
+		fd = ::open(path.toStdString().c_str(),O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+		if (fd < 0){
+			qWarning() << "Can't open " << path << ": " << strerror(errno);
+			return false;
+		}
+		if (isatty(fd)){ // binary data mustn't be mangled by the line discipline
+			termios tio;
+			if (tcgetattr(fd,&tio) == 0){
+				cfmakeraw(&tio);
+				if (baud > 0){
+					speed_t speed = toSpeed(baud);
+					if (speed == B0)
+						qWarning() << "Unsupported baud rate " << baud << " for " << path;
+					else{
+						cfsetispeed(&tio,speed);
+						cfsetospeed(&tio,speed);
+					}
+				}
+				tio.c_cflag |= CLOCAL | CREAD;
+				tcsetattr(fd,TCSANOW,&tio);
+			}
+		}
+	}
+	notifier = new QSocketNotifier(fd,QSocketNotifier::Read,this);
+	connect(notifier,SIGNAL(activated(int)),this,SLOT(readData()));
+	return true;
+}
+
+//
+// Private slots
+//
+
+void DeviceSource::readData()
+{
+	ssize_t n = read(fd,buf,INPUT_READ_SIZE);
+	if (n > 0){
+		received(buf,n);
+	}
+	else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)){
+		// End of file, or the other end of the pipe/terminal has gone
+		if (n < 0) nErrors++;
+		qWarning() << "Finished reading " << qPrintable(sourceName);
+		logStatistics();
+		closeDevice();
+	}
+}
+
+//
+// Private
+//
+
+void DeviceSource::closeDevice()
+{
+	if (notifier){
+		notifier->setEnabled(false);
+		notifier->deleteLater(); // we may be in its slot
+		notifier=NULL;
+	}
+	if (fd >= 0){
+		::close(fd);
+		fd=-1;
+	}
+}
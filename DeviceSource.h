@@ -0,0 +1,63 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __DEVICE_SOURCE_H_
+#define __DEVICE_SOURCE_H_
+
+#include "InputSource.h"
+
+class QSocketNotifier;
+
+// Reads receiver output from a serial port, named pipe, (pseudo-)terminal, 
+// file or stdin (the path "-"). Regular files are read as fast as possible.
+// A terminal is put into raw mode and, optionally, its baud rate set.
+
+class DeviceSource : public InputSource
+{
+	Q_OBJECT
+	
+	public:
+	
+		DeviceSource(QString,int,StreamDecoder *,QObject *parent=0);
+		~DeviceSource();
+		
+		virtual bool open();
+		
+	private slots:
+	
+		void readData();
+		
+	private:
+	
+		void closeDevice();
+		
+		QString path;
+		int baud;
+		int fd;
+		QSocketNotifier *notifier;
+		char buf[INPUT_READ_SIZE];
+};
+
+#endif
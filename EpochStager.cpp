@@ -0,0 +1,115 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "EpochStager.h"
+
+EpochStager::EpochStager(int hold)
+{
+	holdTime=hold;
+	nStaged=nSuperseded=nCommitted=nLate=0;
+	anyCommitted=false;
+	lastCommitted=0;
+	for (int e=0;e<STAGE_MAX_EPOCHS;e++){
+		epochs[e].open=false;
+		epochs[e].nobs=0;
+		for (int s=0;s<STAGE_SLOTS;s++)
+			epochs[e].index[s]=-1;
+	}
+}
+
+// Returns false if there's no room for a new epoch, in which case
+// the oldest should be committed (forced) and the observation staged again.
+
+bool EpochStager::stage(const Observation &o,qint64 now)
+{
+	if (o.PRN < 0 || o.PRN >= STAGE_MAX_PRN) return true; // can't happen, since it's been validated
+	int slot = o.constellation*STAGE_MAX_PRN + o.PRN;
+	
+	if (anyCommitted && o.timestamp <= lastCommitted){
+		if (lastCommitted - o.timestamp <= STAGE_LATE_LIMIT){
+			nLate++;
+			return true;
+		}
+		anyCommitted=false; // start again from this time
+	}
+	
+	Epoch *ep=NULL,*unused=NULL;
+	for (int e=0;e<STAGE_MAX_EPOCHS;e++){
+		if (!epochs[e].open){
+			if (!unused) unused=&(epochs[e]);
+		}
+		else if (epochs[e].timestamp == o.timestamp){
+			ep=&(epochs[e]);
+			break;
+		}
+	}
+	
+	if (!ep){
+		if (!unused) return false;
+		ep=unused;
+		ep->open=true;
+		ep->timestamp=o.timestamp;
+		ep->opened=now;
+		ep->nobs=0;
+	}
+	
+	nStaged++;
+	if (ep->index[slot] >= 0){
+		ep->obs[ep->index[slot]]=o;
+		nSuperseded++;
+	}
+	else{
+		ep->index[slot]=ep->nobs;
+		ep->obs[ep->nobs++]=o;
+	}
+	return true;
+}
+
+// Copies out the oldest epoch that is ready (or the oldest, if forced) and closes it.
+// Returns the number of observations, or 0 if nothing is ready.
+// The buffer must hold STAGE_SLOTS observations.
+
+int EpochStager::commit(qint64 now,Observation *obs,bool force)
+{
+	Epoch *ep=NULL;
+	for (int e=0;e<STAGE_MAX_EPOCHS;e++){
+		if (epochs[e].open && (!ep || epochs[e].timestamp < ep->timestamp))
+			ep=&(epochs[e]);
+	}
+	if (!ep) return 0;
+	if (!force && now - ep->opened < holdTime) return 0;
+	
+	int nobs = ep->nobs;
+	for (int i=0;i<nobs;i++){
+		obs[i]=ep->obs[i];
+		ep->index[obs[i].constellation*STAGE_MAX_PRN + obs[i].PRN]=-1;
+	}
+	ep->open=false;
+	ep->nobs=0;
+	nCommitted++;
+	anyCommitted=true;
+	lastCommitted=ep->timestamp;
+	return nobs;
+}
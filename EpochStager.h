@@ -0,0 +1,81 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __EPOCH_STAGER_H_
+#define __EPOCH_STAGER_H_
+
+#include <QtGlobal>
+
+#include "Observation.h"
+
+#define STAGE_MAX_PRN    64
+#define STAGE_SLOTS      (6*STAGE_MAX_PRN) // constellations x PRNs
+#define STAGE_MAX_EPOCHS 4
+#define STAGE_LATE_LIMIT 60 // in seconds; anything older means the clock has gone back
+
+// Groups observations by epoch before they are applied to the satellites.
+// Within an epoch only the latest observation of each satellite is kept, so an epoch split 
+// across several datagrams, or reported by several inputs, is applied once and all together.
+// An epoch is ready to commit once it has been open for the hold time. Epochs are committed
+// oldest first. An observation for an epoch no later than the last one committed has arrived
+// too late, and is dropped so that the satellites are never taken back in time, unless it is
+// so old that the source's clock must have been reset.
+
+class EpochStager
+{
+	public:
+	
+		EpochStager(int);
+		
+		bool stage(const Observation &,qint64);
+		int  commit(qint64,Observation *,bool force=false);
+		
+		void setHoldTime(int ms){holdTime=ms;}
+		
+		unsigned long long nStaged;
+		unsigned long long nSuperseded; // replaced by a later observation in the same epoch
+		unsigned long long nCommitted;  // epochs
+		unsigned long long nLate;       // dropped, since their epoch had been committed
+		
+	private:
+	
+		class Epoch
+		{
+			public:
+				bool   open;
+				int    timestamp;
+				qint64 opened;
+				int    nobs;
+				short  index[STAGE_SLOTS]; // slot -> obs, or -1
+				Observation obs[STAGE_SLOTS];
+		};
+		
+		Epoch epochs[STAGE_MAX_EPOCHS];
+		int holdTime; // in ms
+		bool anyCommitted;
+		int  lastCommitted; // timestamp
+};
+
+#endif
@@ -0,0 +1,95 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ExpiryWheel.h"
+#include "GNSSSV.h"
+
+ExpiryWheel::ExpiryWheel()
+{
+	for (int i=0;i<WHEEL_SLOTS;i++)
+		wheel[i]=NULL;
+	current=0;
+	count=0;
+}
+
+void ExpiryWheel::schedule(GNSSSV *sv,qint64 tick)
+{
+	if (sv->expiry >= 0)
+		unlink(sv);
+	else
+		count++;
+	if (tick <= current) // overdue, so it goes in the next tick
+		tick = current+1;
+	sv->expiry = tick;
+	GNSSSV *&head = wheel[tick & (WHEEL_SLOTS-1)];
+	sv->wheelPrev = NULL;
+	sv->wheelNext = head;
+	if (head)
+		head->wheelPrev = sv;
+	head = sv;
+}
+
+void ExpiryWheel::cancel(GNSSSV *sv)
+{
+	if (sv->expiry < 0) return;
+	unlink(sv);
+	sv->expiry = -1;
+	count--;
+}
+
+void ExpiryWheel::advance(qint64 tick,QList<GNSSSV *> &expired)
+{
+	qint64 from = current+1;
+	if (tick - from >= WHEEL_SLOTS) // a long gap, so just one revolution
+		from = tick - WHEEL_SLOTS + 1;
+	for (qint64 t=from;t<=tick;t++){
+		GNSSSV *sv = wheel[t & (WHEEL_SLOTS-1)];
+		while (sv){
+			GNSSSV *next = sv->wheelNext;
+			if (sv->expiry <= tick){
+				cancel(sv);
+				expired.append(sv);
+			}
+			sv = next;
+		}
+	}
+	if (tick > current)
+		current = tick;
+}
+
+//
+// Private
+//
+
+void ExpiryWheel::unlink(GNSSSV *sv)
+{
+	if (sv->wheelPrev)
+		sv->wheelPrev->wheelNext = sv->wheelNext;
+	else
+		wheel[sv->expiry & (WHEEL_SLOTS-1)] = sv->wheelNext;
+	if (sv->wheelNext)
+		sv->wheelNext->wheelPrev = sv->wheelPrev;
+	sv->wheelPrev = sv->wheelNext = NULL;
+}
@@ -0,0 +1,63 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __EXPIRY_WHEEL_H_
+#define __EXPIRY_WHEEL_H_
+
+#include <QList>
+#include <QtGlobal>
+
+class GNSSSV;
+
+#define WHEEL_SLOTS 1024 // ticks per revolution, a power of 2
+
+// Expires satellites which have not been updated within their timeout.
+// A satellite sits in the slot for the tick it is due to expire at, in a list threaded 
+// through the satellite itself, so rescheduling it on each update is constant time.
+// Each tick visits only the slot for that tick. A deadline more than a revolution away 
+// shares a slot with nearer ones and is just passed over until its turn comes.
+
+class ExpiryWheel
+{
+	public:
+	
+		ExpiryWheel();
+		
+		void schedule(GNSSSV *,qint64); // (re)schedules at the given tick
+		void cancel(GNSSSV *);
+		void advance(qint64,QList<GNSSSV *> &); // to the given tick, returning what has expired
+		
+		int size(){return count;}
+		
+	private:
+	
+		void unlink(GNSSSV *);
+		
+		GNSSSV *wheel[WHEEL_SLOTS];
+		qint64 current; // the last tick advanced to
+		int count;
+};
+
+#endif
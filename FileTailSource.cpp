@@ -0,0 +1,215 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#endif
+
+#include "FileTailSource.h"
+
+FileTailSource::FileTailSource(QString p,bool s,StreamDecoder *d,QObject *parent):
+	InputSource(QString("file:%1").arg(p),d,parent)
+{
+	path=p;
+	fromStart=s;
+	fd=-1;
+	offset=0;
+	inotifyFd=watch=-1;
+	notifier=NULL;
+	retryTimer=NULL;
+	pollTimer=NULL;
+}
+
+FileTailSource::~FileTailSource()
+{
+	closeFile();
+}
+
+bool FileTailSource::open()
+{
+	retryTimer = new QTimer(this);
+	connect(retryTimer,SIGNAL(timeout()),this,SLOT(tryOpen()));
+	
+	if (!openFile(fromStart)){
+		qWarning() << "Can't open " << path << " - waiting for it";
+		retryTimer->start(TAIL_RETRY_INTERVAL*1000);
+	}
+	return true;
+}
+
+//
+// Private slots
+//
+
+void FileTailSource::tryOpen()
+{
+	if (openFile(true)){ // it's a new file so read all of it
+		retryTimer->stop();
+		nReconnects++;
+	}
+	else if (!retryTimer->isActive())
+		retryTimer->start(TAIL_RETRY_INTERVAL*1000);
+}
+
+void FileTailSource::readEvents()
+{
+#ifdef Q_OS_LINUX
+	char ebuf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	bool gone=false,attrib=false;
+	ssize_t n;
+	while ((n = read(inotifyFd,ebuf,sizeof(ebuf))) > 0){
+		for (char *p = ebuf;p < ebuf + n;p += sizeof(struct inotify_event) + ((struct inotify_event *) p)->len){
+			struct inotify_event *ev = (struct inotify_event *) p;
+			if (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED))
+				gone=true;
+			if (ev->mask & IN_ATTRIB) // an unlink only shows up as this while we hold the file open
+				attrib=true;
+		}
+	}
+	readToEnd();
+	if (gone || (attrib && replaced()))
+		reopen();
+#endif
+}
+
+void FileTailSource::poll()
+{
+	readToEnd();
+	if (replaced())
+		reopen();
+}
+
+void FileTailSource::readToEnd()
+{
+	if (fd < 0) return;
+	
+	struct stat st;
+	if (fstat(fd,&st) == 0 && st.st_size < offset){ // truncated
+		qWarning() << qPrintable(sourceName) << ": truncated - reading from the start";
+		lseek(fd,0,SEEK_SET);
+		offset=0;
+	}
+	
+	ssize_t n;
+	while ((n = read(fd,buf,INPUT_READ_SIZE)) > 0){
+		offset += n;
+		received(buf,n);
+	}
+	if (n < 0 && errno != EAGAIN && errno != EINTR)
+		nErrors++;
+}
+
+//
+// Private
+//
+
+bool FileTailSource::openFile(bool start)
+{
+	fd = ::open(path.toStdString().c_str(),O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	
+	offset = (start ? 0 : lseek(fd,0,SEEK_END));
+	
+#ifdef Q_OS_LINUX
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd >= 0)
+		watch = inotify_add_watch(inotifyFd,path.toStdString().c_str(),IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+	if (inotifyFd >= 0 && watch >= 0){
+		notifier = new QSocketNotifier(inotifyFd,QSocketNotifier::Read,this);
+		connect(notifier,SIGNAL(activated(int)),this,SLOT(readEvents()));
+	}
+	else{
+		qWarning() << qPrintable(sourceName) << ": inotify failed - polling instead";
+		if (inotifyFd >= 0) ::close(inotifyFd);
+		inotifyFd=watch=-1;
+	}
+#endif
+	
+	if (!notifier){
+		pollTimer = new QTimer(this);
+		connect(pollTimer,SIGNAL(timeout()),this,SLOT(poll()));
+		pollTimer->start(TAIL_RETRY_INTERVAL*1000);
+	}
+	
+	readToEnd();
+	return true;
+}
+
+// True if the file we have open is no longer the one at the path, because it has been
+// deleted, or moved and perhaps replaced
+
+bool FileTailSource::replaced()
+{
+	struct stat held,named;
+	if (fd < 0 || fstat(fd,&held) != 0 || held.st_nlink == 0)
+		return true;
+	if (stat(path.toStdString().c_str(),&named) != 0)
+		return true;
+	return held.st_dev != named.st_dev || held.st_ino != named.st_ino;
+}
+
+// Rotated, so the file at the path is opened again, now if it is already there, or when it appears
+
+void FileTailSource::reopen()
+{
+	qInfo() << qPrintable(sourceName) << ": moved or deleted - reopening";
+	closeFile();
+	tryOpen();
+}
+
+void FileTailSource::closeFile()
+{
+	if (notifier){
+		notifier->setEnabled(false);
+		notifier->deleteLater(); // we may be in its slot
+		notifier=NULL;
+	}
+	if (pollTimer){
+		pollTimer->stop();
+		pollTimer->deleteLater(); // as for the notifier
+		pollTimer=NULL;
+	}
+#ifdef Q_OS_LINUX
+	if (inotifyFd >= 0){
+		::close(inotifyFd); // removes the watch too
+		inotifyFd=watch=-1;
+	}
+#endif
+	if (fd >= 0){
+		::close(fd);
+		fd=-1;
+	}
+}
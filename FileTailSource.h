@@ -0,0 +1,78 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __FILE_TAIL_SOURCE_H_
+#define __FILE_TAIL_SOURCE_H_
+
+#include "InputSource.h"
+
+#define TAIL_RETRY_INTERVAL 1 // in seconds
+
+class QSocketNotifier;
+class QTimer;
+
+// Follows a growing file, like tail -F.
+// On Linux, inotify says when the file has been written to. Elsewhere it is polled.
+// If the file is truncated it is read again from the start, and if it is 
+// moved or deleted (log rotation) the file at the path is opened again, as soon as it appears.
+
+class FileTailSource : public InputSource
+{
+	Q_OBJECT
+	
+	public:
+	
+		FileTailSource(QString,bool,StreamDecoder *,QObject *parent=0);
+		~FileTailSource();
+		
+		virtual bool open();
+		
+	private slots:
+	
+		void tryOpen();
+		void readEvents();
+		void poll();
+		void readToEnd();
+		
+	private:
+	
+		bool openFile(bool);
+		bool replaced();
+		void reopen();
+		void closeFile();
+		
+		QString path;
+		bool fromStart;
+		int  fd;
+		long long offset;
+		
+		int  inotifyFd,watch;
+		QSocketNotifier *notifier;
+		QTimer *retryTimer;
+		QTimer *pollTimer;
+		char buf[INPUT_READ_SIZE];
+};
+
+#endif
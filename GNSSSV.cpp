@@ -28,49 +28,186 @@
 
 #include "GNSSSV.h"
 
-GNSSSV::GNSSSV(){}
+unsigned long long GNSSSV::nPoints=0;
+unsigned long long GNSSSV::nVertices=0;
 
-GNSSSV::GNSSSV(int prn,double a,double e,double s,int c,QDateTime &u)
+// Azimuth difference, allowing for wrapping at 360
+static inline float dAz(float a,float b)
 {
+	float d = a-b;
+	if (d > 180.0) d -= 360.0;
+	else if (d < -180.0) d += 360.0;
+	return d;
+}
+
+GNSSSV::GNSSSV()
+{
+	nSkipped=0;
+	expiry=-1;
+	wheelNext=wheelPrev=NULL;
+	allIndex=memberIndex=-1;
+}
+
+GNSSSV::GNSSSV(int prn,double a,double e,double s,int c,QDateTime &u,TrackStore *store)
+{
+	track.store=store;
+	track.slot=store->allocate();
+	store->setIdentity(track.slot,c,prn);
+	store->setSignal(track.slot,s);
 	PRN=prn;
-	az.append(a);
-	elev.append(e);
+	track.append(a,e,u.toTime_t());
+	geometry.update(track);
+	nSkipped=0;
+	expiry=-1;
+	wheelNext=wheelPrev=NULL;
+	allIndex=memberIndex=-1;
+	nPoints++;
+	nVertices++;
 	sn=s;
 	constellation=c;
 	lastUpdate=u;
 	qDebug() << "New PRN " << PRN;
 }
 
+GNSSSV::GNSSSV(TrackStore *store,int slot)
+{
+	track.store=store;
+	track.slot=slot;
+	PRN=store->PRN(slot);
+	constellation=store->constellation(slot);
+	sn=store->signal(slot);
+	lastUpdate.setTime_t(track.lastTime());
+	geometry.update(track);
+	nSkipped=0;
+	expiry=-1;
+	wheelNext=wheelPrev=NULL;
+	allIndex=memberIndex=-1;
+}
+
 GNSSSV::GNSSSV(GNSSSV & gnsssv)
 {
 	*this = gnsssv;
+	expiry=-1; // not in the wheel
+	wheelNext=wheelPrev=NULL;
+	allIndex=memberIndex=-1;
+	if (track.store)
+		track.slot=track.store->duplicate(gnsssv.track.slot);
+}
+
+GNSSSV::~GNSSSV()
+{
+	if (track.store)
+		track.store->release(track.slot);
+}
+
+void *GNSSSV::operator new(size_t sz)
+{
+	if (sz != sizeof(GNSSSV)) // a derived class
+		return ::operator new(sz);
+	return pool()->allocate();
+}
+
+void GNSSSV::operator delete(void *p,size_t sz)
+{
+	if (sz != sizeof(GNSSSV))
+		::operator delete(p);
+	else
+		pool()->release(p);
+}
+
+// Made on first use and never deleted, so that it outlives every satellite
+
+SlabPool *GNSSSV::pool()
+{
+	static SlabPool *p = new SlabPool(sizeof(GNSSSV));
+	return p;
 }
 
-GNSSSV::~GNSSSV(){}
+// The track is simplified as it grows. The newest point is provisional: if the segment from the 
+// last fixed vertex to the new point passes within the tolerance (in degrees) of the provisional 
+// point and every point dropped before it, the provisional point is dropped and the new point 
+// takes its place. Otherwise the provisional point becomes a fixed vertex.
+// So the newest point is always the current position.
 
-void GNSSSV::update(double a,double e,double s,QDateTime &u,double threshold)
+void GNSSSV::update(double a,double e,double s,QDateTime &u,double tolerance)
 {
 	// if this precedes the last update, just ignore it
 	if (u<lastUpdate) return;
 	lastUpdate=u;
-	// if the position is unchanged ignore it
+	sn = s;
+	track.setSignal(s);
+	nPoints++;
 	
-	if (!az.isEmpty()){
-		if ((fabs(az.last()-a)<= threshold) && (fabs(elev.last()-e)<=threshold)) return;
-		// a further refinement - drop points where we are moving in a straight line
-		// this also cleans up the jaggies a bit 
-// 		if ((az.size() > 1) && (az.last()==a || elev.last()==e)) // don't drop the first point otherwise we don't start a track until something changes
-// 		{
-// 			qDebug() << "Dropping point " << PRN << ":" << az.last() << " " << elev.last();
-// 			az.pop_back();
-// 			elev.pop_back();
-// 			
-// 		}
+	if (tolerance > 0.0 && track.size() >= 2 && nSkipped < SIMPLIFY_WINDOW && fits(a,e,tolerance)){
+		skippedAz[nSkipped]=track.lastAz();
+		skippedElev[nSkipped]=track.lastElev();
+		nSkipped++;
+		track.replaceLast(a,e,u.toTime_t());
+		geometry.update(track);
+		return;
 	}
 	
-
-	az.append(a);
-	elev.append(e);
-	sn = s;
+	// A satellite that isn't moving (GEO, SBAS) would otherwise add a vertex each time the window fills
+	if (tolerance > 0.0 && track.size() >= 2 && nSkipped == SIMPLIFY_WINDOW && stationary(a,e,tolerance)){
+		track.replaceLast(a,e,u.toTime_t());
+		geometry.update(track);
+		return;
+	}
+	
+	track.append(a,e,u.toTime_t());
+	geometry.update(track);
+	nSkipped=0;
+	nVertices++;
 	//qDebug() << "Updated " << PRN << ":" << a << " " << e;
-}
\ No newline at end of file
+}
+
+//
+// Private
+//
+
+// Checks whether the segment from the last fixed vertex to (a,e) is within 
+// the tolerance of the provisional point and the points already dropped
+
+bool GNSSSV::fits(float a,float e,double tolerance)
+{
+	int n = track.size();
+	float a0 = track.az(n-2), e0 = track.elev(n-2);
+	
+	// in coordinates relative to the fixed vertex
+	float dx = dAz(a,a0), dy = e-e0;
+	float len2 = dx*dx+dy*dy;
+	float tol2 = tolerance*tolerance;
+	
+	for (int i=0;i<=nSkipped;i++){
+		float px,py;
+		if (i == nSkipped){ // the provisional point
+			px = dAz(track.az(n-1),a0);
+			py = track.elev(n-1)-e0;
+		}
+		else{
+			px = dAz(skippedAz[i],a0);
+			py = skippedElev[i]-e0;
+		}
+		// distance to the segment
+		float t = (len2 > 0.0 ? (px*dx+py*dy)/len2 : 0.0);
+		if (t < 0.0) t=0.0;
+		else if (t > 1.0) t=1.0;
+		float ex = px-t*dx, ey = py-t*dy;
+		if (ex*ex+ey*ey > tol2) return false;
+	}
+	return true;
+}
+
+// Checks whether both the provisional point and (a,e) are within the tolerance of the last fixed vertex
+
+bool GNSSSV::stationary(float a,float e,double tolerance)
+{
+	int n = track.size();
+	float a0 = track.az(n-2), e0 = track.elev(n-2);
+	float tol2 = tolerance*tolerance;
+	float dx = dAz(a,a0), dy = e-e0;
+	if (dx*dx+dy*dy > tol2) return false;
+	dx = dAz(track.az(n-1),a0);
+	dy = track.elev(n-1)-e0;
+	return dx*dx+dy*dy <= tol2;
+}
@@ -31,6 +31,12 @@
 
 #include <QList>
 
+#include "SlabPool.h"
+#include "TrackGeometry.h"
+#include "TrackStore.h"
+
+#define SIMPLIFY_WINDOW 32 // maximum number of points replaced by one segment
+
 class GNSSSV
 {
 	public:
@@ -38,21 +44,45 @@ class GNSSSV
 		enum Constellation {Beidou=0,GPS=1,Galileo=2,GLONASS=3,QZSS=4,SBAS=5};
 
 		GNSSSV();
-		GNSSSV(int,double,double,double,int,QDateTime &);
+		GNSSSV(int,double,double,double,int,QDateTime &,TrackStore *);
+		GNSSSV(TrackStore *,int); // from a restored slot
 		GNSSSV(GNSSSV &);
 
-		void update(double,double,double,QDateTime &,double threshold=0.0);
+		void update(double,double,double,QDateTime &,double tolerance=0.0);
 		
 		~GNSSSV();
+		
+		// satellites come and go all day, so they are recycled from a pool
+		static void *operator new(size_t);
+		static void  operator delete(void *,size_t);
+		static SlabPool *pool();
 
 		QDateTime lastUpdate;
 		bool changed;
 		
 		int PRN;
-		QList<double> az,elev;
+		Track track; // points are in the TrackStore
+		TrackGeometry geometry; // what's drawn
 		double sn;
 		int constellation;
-
+		
+		// for the ExpiryWheel
+		qint64 expiry; // tick, or -1 if not scheduled
+		GNSSSV *wheelNext,*wheelPrev;
+		
+		// for the SatelliteTable, positions in its lists
+		int allIndex,memberIndex;
+		
+		static unsigned long long nPoints,nVertices; // offered to, and kept by, the simplifier
+		
+	private:
+	
+		bool fits(float,float,double);
+		bool stationary(float,float,double);
+		
+		// points which have been dropped since the last fixed vertex
+		int   nSkipped;
+		float skippedAz[SIMPLIFY_WINDOW],skippedElev[SIMPLIFY_WINDOW];
 };
 
 #endif
\ No newline at end of file
@@ -36,23 +36,32 @@
 #include <QInputDialog>
 #include <QMenu>
 #include <QRegExp>
-#include <QUdpSocket>
+#include <QThread>
 #include <QVBoxLayout>
 
-#include <sys/types.h> // flimflummery
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-
 #include "ConstellationProperties.h"
+#include "ExpiryWheel.h"
 #include "GNSSView.h"
 #include "GNSSViewApp.h"
 #include "GNSSViewWidget.h"
+#include "Ingestor.h"
+#include "ObservationRing.h"
 #include "PowerManager.h"
+#include "SatelliteTable.h"
+#include "SlabPool.h"
+#include "TrackArchive.h"
+#include "TrackGeometry.h"
+#include "TrackStore.h"
 
 #define VERSION_INFO  "v1.0.2"
-#define TRACKING_TIMEOUT 120
+#define RING_SIZE 4096
+#define EPOCH_HOLD 250 // in ms
+#define TRACK_TOLERANCE 0.05 // in degrees, about half a pixel on a 1920 pixel wide display
+#define SCRUB_STEP 300    // in seconds, 3600 with shift
+#define SCRUB_SPAN 86400  // how far back the tracks can be shown
+#define MEMORY_STATS_INTERVAL 3600 // in seconds
+#define ARCHIVE_FLUSH_INTERVAL 10  // in seconds
+#define COVERAGE_SPAN 168 // in hours
 
 GNSSView::GNSSView(QStringList & args)
 {
@@ -133,17 +142,26 @@ GNSSView::GNSSView(QStringList & args)
 	
 	latitude=-33.87;
 	longitude=151.21;
-	address="";
-	port=-1;
+	ringSize=RING_SIZE;
+	epochHold=EPOCH_HOLD;
+	trackTolerance=TRACK_TOLERANCE;
+	scrubTime=0;
+	epochClock.start(); // also the clock for expiring satellites
+	lastMemoryStats=0;
+	archive=NULL;
+	lastArchiveFlush=0;
 	
 	for (int c = GNSSSV::Beidou;c<= GNSSSV::SBAS;c++){ // create them all so that lookups are easy
 		constellations.append(new ConstellationProperties(c));
 	}
+	tracks = new TrackStore();
+	birds = new SatelliteTable(constellations);
+	expiry = new ExpiryWheel();
 	
 	// Note: readConfig needs 'view'
 	QVBoxLayout * vb = new QVBoxLayout(this);
 	vb->setContentsMargins(0,0,0,0);
-	view = new GNSSViewWidget(NULL,&birds);
+	view = new GNSSViewWidget(NULL,birds);
 	vb->addWidget(view);
 	
 	QString config = app->locateResource("gnssview.xml");
@@ -153,40 +171,27 @@ GNSSView::GNSSView(QStringList & args)
 	
 	view->setLocation(latitude,longitude);
 	
+	restoreTracks();
+	
 	createActions();
 	setContextMenuPolicy(Qt::CustomContextMenu);
 	connect(this,SIGNAL(customContextMenuRequested ( const QPoint & )),this,SLOT(createContextMenu(const QPoint &)));
 
-	udpSocket = new QUdpSocket(this);
-  udpSocket->bind(port,QUdpSocket::ShareAddress);
+	// Networking and parsing are done in their own thread
+	ring = new ObservationRing(ringSize);
+	ingestor = new Ingestor(constellations,ring);
+	for (int i=0;i<inputs.size();i++)
+		ingestor->addInput(inputs.at(i));
+	ingestThread = new QThread(this);
+	ingestor->moveToThread(ingestThread);
+	connect(ingestThread,SIGNAL(finished()),ingestor,SLOT(deleteLater()));
+	ingestThread->start();
+	QMetaObject::invokeMethod(ingestor,"start",Qt::QueuedConnection);
 	
-	// Start of flimflummery
-	// Newer versions of Qt support this but for the moment we'll do it the Unix way 
-	int socketfd = udpSocket->socketDescriptor();
-	if (socketfd != -1){
-		ip_mreq mreq;
-		memset(&mreq,0,sizeof(ip_mreq));
-		mreq.imr_multiaddr.s_addr = inet_addr(address.toStdString().c_str()); // group addr
-		mreq.imr_interface.s_addr = htons(INADDR_ANY); // use default
-
-		//Make this a member of the Multicast Group
-		if(setsockopt(socketfd, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const void *)&mreq,sizeof(mreq)) < 0){
-			qDebug("Failed to add to multicast group");
-		}
-		
-		// set TTL (Time To Live)
-		unsigned int ttl = 38; // restricted to 38 hops
-		if (setsockopt(socketfd, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl) ) < 0){
-			qDebug("Failed to set TTL");
-		}
-	}
-	else{
-		qDebug() << "Bad socket fd!";
-	}
-	// End of flimflummery
+	// and the observations are picked up once per frame, and applied an epoch at a time
+	stager = new EpochStager(epochHold);
+	connect(view,SIGNAL(aboutToRender()),this,SLOT(drainObservations()));
 	
-  connect(udpSocket, SIGNAL(readyRead()),this, SLOT(readPendingDatagrams()));
-				 
 	updateTimer = new QTimer(this);
 	connect(updateTimer,SIGNAL(timeout()),this,SLOT(updateView()));
 	
@@ -196,9 +201,50 @@ GNSSView::GNSSView(QStringList & args)
     qDebug() << "GNSSView " << width() << " " << height() ;
 }
 
+GNSSView::~GNSSView()
+{
+	ingestThread->quit();
+	ingestThread->wait();
+	delete ring;
+	qInfo() << "tracks: points=" << GNSSSV::nPoints << " vertices=" << GNSSSV::nVertices;
+	qInfo() << "epochs: staged=" << stager->nStaged << " superseded=" << stager->nSuperseded << " committed=" << stager->nCommitted << " late=" << stager->nLate;
+	delete stager;
+	logMemoryStatistics();
+	tracks->close(); // first, so that the tracks are kept
+	delete archive;
+	delete birds;
+	delete expiry;
+	delete tracks;
+}
+
+// The left and right arrows move the time the tracks are shown at, End goes back to the latest
+
 void 	GNSSView::keyPressEvent (QKeyEvent *ev)
 {
-	QWidget::keyPressEvent(ev);
+	int step = (ev->modifiers() & Qt::ShiftModifier ? 3600 : SCRUB_STEP);
+	uint now = QDateTime::currentDateTime().toTime_t();
+	switch (ev->key())
+	{
+		case Qt::Key_Left:
+			scrubTime = qMax((int) (scrubTime == 0 ? now : scrubTime) - step,(int) now - SCRUB_SPAN);
+			view->showTracksAt(scrubTime);
+			break;
+		case Qt::Key_Right:
+			if (scrubTime != 0){
+				scrubTime += step;
+				if (scrubTime >= (int) now)
+					scrubTime = 0;
+				view->showTracksAt(scrubTime);
+			}
+			break;
+		case Qt::Key_End:
+			scrubTime = 0;
+			view->showTracksAt(scrubTime);
+			break;
+		default:
+			QWidget::keyPressEvent(ev);
+			break;
+	}
 	powerManager->deviceEvent();
 }
 
@@ -220,17 +266,19 @@ void GNSSView::updateView()
 	
 	QDateTime now = QDateTime::currentDateTime();
 
-	QList<GNSSSV *>::iterator it=birds.begin();
-	while ( it != birds.end() ){
-		if ((*it)->lastUpdate.secsTo(now) > TRACKING_TIMEOUT){
-				qDebug() << "dead bird";
-				GNSSSV *ptr = *it;
-				it = birds.erase(it); // iterator 'it' is next item 
-				delete ptr;
-		}
-		else{
-		 ++it;
-		}
+	QList<GNSSSV *> expired;
+	expiry->advance(epochClock.elapsed()/1000,expired);
+	for (int i=0;i<expired.size();i++){
+		qDebug() << "dead bird";
+		birds->remove(expired.at(i));
+	}
+	if (archive && epochClock.elapsed()/1000 - lastArchiveFlush >= ARCHIVE_FLUSH_INTERVAL){
+		archive->flush();
+		lastArchiveFlush = epochClock.elapsed()/1000;
+	}
+	if (epochClock.elapsed()/1000 - lastMemoryStats >= MEMORY_STATS_INTERVAL){
+		logMemoryStatistics();
+		lastMemoryStats = epochClock.elapsed()/1000;
 	}
 	view->update(now);
 	
@@ -294,31 +342,56 @@ void GNSSView::readConfig(QString s)
 			QStringList sl=lc.split(",");
 			for (int i=0;i<sl.length();i++){
 				if (sl.at(i)=="beidou"){
-					constellations.at(GNSSSV::Beidou)->active=true;
+					constellations.at(GNSSSV::Beidou)->setActive(true);
 					view->setConstellationActive(GNSSSV::Beidou);
 				}
 				else if (sl.at(i)=="gps"){
-					constellations.at(GNSSSV::GPS)->active=true;
+					constellations.at(GNSSSV::GPS)->setActive(true);
 					view->setConstellationActive(GNSSSV::GPS);
 				}
 				else if (sl.at(i)=="glonass"){
-					constellations.at(GNSSSV::GLONASS)->active=true;
+					constellations.at(GNSSSV::GLONASS)->setActive(true);
 					view->setConstellationActive(GNSSSV::GLONASS);
 				}
 				else if (sl.at(i)=="galileo"){
-					constellations.at(GNSSSV::Galileo)->active=true;
+					constellations.at(GNSSSV::Galileo)->setActive(true);
 					view->setConstellationActive(GNSSSV::Galileo);
 				}
 				else if (sl.at(i)=="qzss"){
-					constellations.at(GNSSSV::QZSS)->active=true;
+					constellations.at(GNSSSV::QZSS)->setActive(true);
 					view->setConstellationActive(GNSSSV::QZSS);
 				}
 				else if (sl.at(i)=="sbas"){
-					constellations.at(GNSSSV::SBAS)->active=true;
+					constellations.at(GNSSSV::SBAS)->setActive(true);
 					view->setConstellationActive(GNSSSV::SBAS);
 				}
 			}
 		}
+		else if (elem.tagName()=="timeouts"){
+			QDomElement cel=elem.firstChildElement();
+			while(!cel.isNull()){
+				int t = cel.text().toInt();
+				if (t <= 0)
+					qWarning() << "Bad timeout" << cel.text();
+				else if (cel.tagName() == "default"){
+					for (int c=0;c<constellations.size();c++)
+						constellations.at(c)->timeout=t;
+				}
+				else if (cel.tagName()=="beidou")
+					constellations.at(GNSSSV::Beidou)->timeout=t;
+				else if (cel.tagName()=="gps")
+					constellations.at(GNSSSV::GPS)->timeout=t;
+				else if (cel.tagName()=="glonass")
+					constellations.at(GNSSSV::GLONASS)->timeout=t;
+				else if (cel.tagName()=="galileo")
+					constellations.at(GNSSSV::Galileo)->timeout=t;
+				else if (cel.tagName()=="qzss")
+					constellations.at(GNSSSV::QZSS)->timeout=t;
+				else if (cel.tagName()=="sbas")
+					constellations.at(GNSSSV::SBAS)->timeout=t;
+				cel=cel.nextSiblingElement();
+			}
+		}
 		else if (elem.tagName()=="receiver"){
 			view->setReceiver(elem.text());
 		}
@@ -332,15 +405,94 @@ void GNSSView::readConfig(QString s)
 				cel=cel.nextSiblingElement();
 			}
 		}
-		else if (elem.tagName()=="network"){
+		else if (elem.tagName()=="network"){ // a single UDP input, as before <inputs>
+			InputSpec spec;
+			spec.type="udp";
+			readInputConfig(elem,spec);
+			if (spec.port > 0)
+				inputs.append(spec);
+			QDomElement qel=elem.firstChildElement("queue");
+			if (!qel.isNull())
+				ringSize=qMax(qel.text().toInt(),MAX_OBSERVATIONS); // must hold a datagram's worth
+		}
+		else if (elem.tagName()=="stream"){ // a single device input, likewise
+			InputSpec spec;
+			spec.type="serial";
+			readInputConfig(elem,spec);
+			if (!spec.path.isEmpty())
+				inputs.append(spec);
+		}
+		else if (elem.tagName()=="inputs"){
+			QDomElement cel=elem.firstChildElement();
+			while(!cel.isNull()){
+				if (cel.tagName() == "input"){
+					InputSpec spec;
+					spec.type=cel.attribute("type").trimmed().toLower();
+					readInputConfig(cel,spec);
+					inputs.append(spec);
+				}
+				else if (cel.tagName() == "queue")
+					ringSize=qMax(cel.text().toInt(),MAX_OBSERVATIONS); // must hold a datagram's worth
+				else if (cel.tagName() == "epochhold")
+					epochHold=qMax(cel.text().toInt(),0);
+				cel=cel.nextSiblingElement();
+			}
+		}
+		else if (elem.tagName()=="tracks"){
+			int maxPoints=TRACK_MAX_POINTS,maxAge=TRACK_MAX_AGE;
+			QString trackFile;
 			QDomElement cel=elem.firstChildElement();
 			while(!cel.isNull()){
-				if (cel.tagName() == "address")
-					address=cel.text().trimmed();
-				else if (cel.tagName() == "port")
-					port=cel.text().toInt();
+				if (cel.tagName() == "maxpoints")
+					maxPoints=cel.text().toInt();
+				else if (cel.tagName() == "maxage")
+					maxAge=cel.text().toInt();
+				else if (cel.tagName() == "tolerance")
+					trackTolerance=cel.text().toDouble();
+				else if (cel.tagName() == "file")
+					trackFile=cel.text().trimmed();
+				else if (cel.tagName() == "encoding"){
+					QString txt=cel.text().toLower().trimmed();
+					if (txt=="centidegrees")
+						tracks->setEncoding(TrackStore::Centidegrees);
+					else if (txt=="float")
+						tracks->setEncoding(TrackStore::Float);
+					else
+						qWarning() << "Unknown track encoding" << txt;
+				}
 				cel=cel.nextSiblingElement();
 			}
+			tracks->setLimits(maxPoints,maxAge);
+			if (!trackFile.isEmpty())
+				tracks->open(trackFile);
+		}
+		else if (elem.tagName()=="archive"){
+			QString dir;
+			int days=ARCHIVE_DAYS;
+			int span=COVERAGE_SPAN;
+			bool coverage=true;
+			QDomElement cel=elem.firstChildElement();
+			while(!cel.isNull()){
+				if (cel.tagName() == "directory")
+					dir=cel.text().trimmed();
+				else if (cel.tagName() == "days")
+					days=cel.text().toInt();
+				else if (cel.tagName() == "coverage")
+					coverage = (cel.text().toLower().trimmed() == "yes");
+				else if (cel.tagName() == "span")
+					span=cel.text().toInt();
+				cel=cel.nextSiblingElement();
+			}
+			if (!dir.isEmpty()){
+				delete archive;
+				archive = new TrackArchive(dir,days);
+				if (!archive->isOpen()){
+					delete archive;
+					archive=NULL;
+				}
+				else
+					view->setArchive(archive,coverage ? span*3600 : 0);
+			}
 		}
 		else if (elem.tagName()=="animation"){
 			QDomElement cel=elem.firstChildElement();
@@ -348,6 +500,9 @@ void GNSSView::readConfig(QString s)
 			double period=60;
 			int skyupdate=60;
 			bool smooth=true;
+			int kernel=TrackGeometry::MovingAverage;
+			int smoothWidth=SMOOTH_WIDTH;
+			int subdivisions=SMOOTH_SUBDIVISIONS;
 			snMax=255.0;
 			while(!cel.isNull()){
 				if (cel.tagName() == "period")
@@ -363,9 +518,29 @@ void GNSSView::readConfig(QString s)
 					txt=txt.trimmed();
 					smooth = (txt=="yes");
 				}
+				else if (cel.tagName() == "smoothing"){
+					QString txt=cel.text().toLower();
+					txt=txt.trimmed();
+					if (txt=="average")
+						kernel=TrackGeometry::MovingAverage;
+					else if (txt=="catmullrom")
+						kernel=TrackGeometry::CatmullRom;
+					else
+						qWarning() << "Unknown smoothing" << txt;
+				}
+				else if (cel.tagName() == "smoothwidth")
+					smoothWidth=cel.text().toInt();
+				else if (cel.tagName() == "subdivisions")
+					subdivisions=cel.text().toInt();
+				else if (cel.tagName() == "vertexbuffers")
+					view->setVertexBuffers(cel.text().toLower().trimmed() == "yes");
 				cel=cel.nextSiblingElement();
 			}
-			view->setAnimation(fps,period,skyupdate,smooth);
+			view->setAnimation(fps,period,skyupdate);
+			if (!smooth)
+				TrackGeometry::setKernel(TrackGeometry::None,0);
+			else
+				TrackGeometry::setKernel(kernel,kernel==TrackGeometry::CatmullRom ? subdivisions : smoothWidth);
 		}
 		else if (elem.tagName()=="images"){
 			QDomElement cel=elem.firstChildElement();
@@ -435,56 +610,126 @@ void GNSSView::readConfig(QString s)
 	
 }
 
-void GNSSView::readPendingDatagrams()
+void GNSSView::readInputConfig(QDomElement &elem,InputSpec &spec)
+{
+	QDomElement cel=elem.firstChildElement();
+	while(!cel.isNull()){
+		QString val=cel.text().trimmed();
+		if (cel.tagName() == "format")
+			spec.format=val.toLower();
+		else if (cel.tagName() == "address" || cel.tagName() == "host")
+			spec.address=val;
+		else if (cel.tagName() == "port")
+			spec.port=val.toInt();
+		else if (cel.tagName() == "interface")
+			spec.iface=val;
+		else if (cel.tagName() == "receive")
+			spec.backend=val.toLower();
+		else if (cel.tagName() == "path")
+			spec.path=val;
+		else if (cel.tagName() == "baud")
+			spec.baud=val.toInt();
+		else if (cel.tagName() == "from")
+			spec.fromStart=(val.toLower() == "start");
+		cel=cel.nextSiblingElement();
+	}
+}
+
+void GNSSView::drainObservations()
+{
+	qint64 now = epochClock.elapsed();
+	int nobs;
+	while ((nobs = ring->pop(observations,MAX_OBSERVATIONS)) > 0){
+		for (int i=0;i<nobs;i++){
+			if (!stager->stage(observations[i],now)){ // too many epochs open
+				commitEpoch(now,true);
+				stager->stage(observations[i],now);
+			}
+		}
+	}
+	while (commitEpoch(now,false));
+}
+
+bool GNSSView::commitEpoch(qint64 now,bool force)
 {
-	while (udpSocket->hasPendingDatagrams()) {
-		QByteArray datagram;
-		datagram.resize(udpSocket->pendingDatagramSize());
-		QHostAddress sender;
-		quint16 senderPort;
-
-		udpSocket->readDatagram(datagram.data(), datagram.size(),&sender, &senderPort);
-		//qDebug() << datagram.data();
-		
-		// Parse it
-		// Data is of the form
-		// timestamp,constellation,prn,az,el,sn
-		 QString str(datagram.data());
-		 QStringList svd = str.split("\n");
-		 for (int i=0;i<svd.size();i++){
-			 QStringList sv = svd.at(i).split(",");
-			 if (sv.size() == 6){
-				 int c   = sv.at(1).toInt();
-				 if (c<GNSSSV::Beidou || c > GNSSSV::SBAS) continue; // ignore - bad constellation identifier
+	int nobs = stager->commit(now,epochObservations,force);
+	if (nobs == 0) return false;
+	for (int i=0;i<nobs;i++)
+		updateBird(epochObservations[i]);
+	view->epochCommitted();
+	return true;
+}
+
+void GNSSView::updateBird(Observation &o)
+{
+	// The parser has already checked that the constellation is active and the PRN is sane
+	double sn = o.sn/snMax; // prescale
+	QDateTime u;
+	u.setTime_t(o.timestamp);
 	
-				 if (constellations.at(c)->active){
-						int prn = sv.at(2).toInt();
-						double az=sv.at(3).toDouble();
-						double elev=sv.at(4).toDouble();
-						double sn = sv.at(5).toDouble()/snMax; // prescale
-						QDateTime u;
-						u.setTime_t(sv.at(0).toInt());
-						
-						int idx=-1;
-						for (int b=0;b<birds.size();b++){
-							if (birds.at(b)->constellation == c && birds.at(b)->PRN == prn){
-								idx =b;
-								break;
-							}
-						}
-						if (idx >= 0){
-							birds.at(idx)->update(az,elev,sn,u,0.5); // FIXME hardcoded parameter
-						}
-						else {// new bird
-							// that the PRN is sane before adding it
-							ConstellationProperties *cprop = constellations.at(c); // already checked this is OK
-							if (prn >= cprop->svIDmin && prn<=cprop->svIDmax)
-								birds.append(new GNSSSV(prn,az,elev,sn,c,u));
-						}
-				 }
-			 } // otherwise ignore it
-		 }
+	GNSSSV *sv = birds->find(o.constellation,o.PRN);
+	if (sv){
+		sv->update(o.az,o.elev,sn,u,trackTolerance);
+	}
+	else {// new bird
+		sv = new GNSSSV(o.PRN,o.az,o.elev,sn,o.constellation,u,tracks);
+		if (!birds->insert(sv)){
+			delete sv;
+			return;
+		}
+	}
+	expiry->schedule(sv,epochClock.elapsed()/1000 + constellations.at(o.constellation)->timeout);
+	if (archive)
+		archive->add(o.constellation,o.PRN,o.timestamp,o.az,o.elev);
+}
+
+// The pools satellites and their tracks are recycled from
+
+void GNSSView::logMemoryStatistics()
+{
+	SlabPool *p = GNSSSV::pool();
+	qInfo() << "satellite pool: capacity=" << p->capacity() << " in use=" << p->inUse() << " high water=" << p->highWater() << " free=" << p->available();
+	qInfo() << "track slots: capacity=" << tracks->slotCount() << " in use=" << tracks->slotsInUse() << " high water=" << tracks->slotsHighWater() << " free=" << tracks->slotsFree();
+	for (int c=0;c<GEOMETRY_CHUNK_CLASSES;c++){
+		p = TrackGeometry::chunkPool(c);
+		if (p)
+			qInfo() << "geometry chunks (" << (GEOMETRY_MIN_CHUNK << c) << " vertices): capacity=" << p->capacity() << " in use=" << p->inUse() << " high water=" << p->highWater() << " free=" << p->available();
+	}
+}
+
+// Satellites whose tracks were saved in the track file, and which haven't timed out,
+// are put straight back in the sky
+
+void GNSSView::restoreTracks()
+{
+	QList<int> saved = tracks->takeRestored();
+	uint now = QDateTime::currentDateTime().toTime_t();
+	qint64 tick = epochClock.elapsed()/1000;
+	int nRestored=0;
+	for (int i=0;i<saved.size();i++){
+		int s = saved.at(i);
+		int last = tracks->time(s,tracks->size(s)-1);
+		int c = tracks->constellation(s);
+		int prn = tracks->PRN(s);
+		if (c >= constellations.size() || prn < constellations.at(c)->svIDmin || prn > constellations.at(c)->svIDmax){
+			qWarning() << "ignoring a saved track for" << c << ":" << prn;
+			tracks->release(s);
+			continue;
+		}
+		if (!constellations.at(c)->isActive() || (int) (now - last) > constellations.at(c)->timeout){
+			tracks->release(s);
+			continue;
+		}
+		GNSSSV *sv = new GNSSSV(tracks,s);
+		if (birds->insert(sv)){
+			expiry->schedule(sv,tick + constellations.at(c)->timeout - (now - last));
+			nRestored++;
+		}
+		else
+			delete sv;
 	}
+	if (saved.size() > 0)
+		qInfo() << "restored" << nRestored << "of" << saved.size() << "tracks";
 }
 
 void GNSSView::createContextMenu(const QPoint &)
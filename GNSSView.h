@@ -29,18 +29,29 @@
 #include <QList>
 #include <QWidget>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QList>
 
+#include "EpochStager.h"
 #include "GNSSSV.h"
+#include "InputSource.h"
+#include "Observation.h"
 
 class QAction;
+class QDomElement;
 class QLabel;
+class QThread;
 class QTimer;
-class QUdpSocket;
 
 class ConstellationProperties;
+class ExpiryWheel;
 class GNSSViewWidget;
+class Ingestor;
+class ObservationRing;
 class PowerManager;
+class SatelliteTable;
+class TrackArchive;
+class TrackStore;
 
 class GNSSView : public QWidget
 {
@@ -49,6 +60,7 @@ class GNSSView : public QWidget
 	public:
 
 		GNSSView(QStringList &);
+		~GNSSView();
 		
 	protected slots:
 
@@ -67,13 +79,19 @@ class GNSSView : public QWidget
 		
 		void createContextMenu(const QPoint &);
 		
-		void readPendingDatagrams();
+		void drainObservations();
 		
 	private:
   	
 		void readConfig(QString s);
+		void readInputConfig(QDomElement &,InputSpec &);
 		void createActions();
 		
+		bool commitEpoch(qint64,bool);
+		void updateBird(Observation &);
+		void restoreTracks();
+		void logMemoryStatistics();
+		
 		QString configFile;
 		bool fullScreen;
 
@@ -88,15 +106,31 @@ class GNSSView : public QWidget
 		QAction *toggleForegroundAction;
 		QAction *offsetTimeAction;
 		
-		QUdpSocket *udpSocket;
-		QString address;
-		int     port;
+		QList<InputSpec> inputs;
+		int     ringSize;
+		
+		QThread  *ingestThread;
+		Ingestor *ingestor;
+		ObservationRing *ring;
+		Observation observations[MAX_OBSERVATIONS];
+		
+		EpochStager *stager;
+		int epochHold; // in ms
+		double trackTolerance; // in degrees
+		int scrubTime; // UNIX time the tracks are shown at, 0 for the latest
+		QElapsedTimer epochClock;
+		Observation epochObservations[STAGE_SLOTS];
 		
 		double latitude,longitude;
 		
 		double snMax;
 		
-		QList<GNSSSV *> birds;
+		SatelliteTable *birds;
+		ExpiryWheel *expiry; // in seconds since startup
+		qint64 lastMemoryStats; // ditto
+		TrackStore *tracks;
+		TrackArchive *archive;
+		qint64 lastArchiveFlush; // in seconds since startup
 		QList<ConstellationProperties *> constellations;
 };
 
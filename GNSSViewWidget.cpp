@@ -30,16 +30,22 @@
 #include <GL/glu.h> 
 
 #include <QDebug>
+#include <QGLBuffer>
+#include <QGLShaderProgram>
 #include <QTimer>
 #include <QtXml>
 
 #include "ConstellationProperties.h"
-#include "GLText.h"
+#include "GlyphAtlas.h"
 #include "GNSSSV.h"
 #include "GNSSViewApp.h"
 #include "GNSSViewWidget.h"
+#include "SatelliteTable.h"
 #include "Sun.h"
 #include "SkyModel.h"
+#include "SpriteBatch.h"
+#include "TrackArchive.h"
+#include "TrackBuffer.h"
 
 #define CHECK_GLERROR() \
 { \
@@ -53,14 +59,18 @@
 #define EL1  90
 
 #define HORIZON_OFFSET 0.1
+#define COVERAGE_ALPHA 0.15
+#define PAST_TRACK_SPAN 21600 // in seconds, how far back the tracks of satellites no longer tracked are drawn
 
-GNSSViewWidget::GNSSViewWidget(QWidget *parent,QList<GNSSSV *> *b):QGLWidget(parent)
+#define FRAME_STATS_INTERVAL 600 // in seconds
+
+GNSSViewWidget::GNSSViewWidget(QWidget *parent,SatelliteTable *b):QGLWidget(parent)
 {
 	gridOn=true;
 	animatedSky=true;
 	showForeground=true;
 	signalLevels=true;
-	smooth=true;
+	tracksChanged=true;
 	
 	minElevation=-10.0;
 	maxElevation=30.0;
@@ -71,18 +81,34 @@ GNSSViewWidget::GNSSViewWidget(QWidget *parent,QList<GNSSSV *> *b):QGLWidget(par
 	birds=b;
 	
 	tOffset=0;
+	trackTime=0;
+	archive=NULL;
+	coverageSpan=0;
+	coverageBuffer=NULL;
+	coverageVertices=0;
+	coverageRevision=coverageTime=-1;
+	coverageAzMin=coverageAzMax=0.0;
+	pastRevision=pastTime=-1;
+	pastAzMin=pastAzMax=0.0;
+	
+	vertexBuffers=true;
+	trackProgram=NULL;
+	nFrames=frameNumber=0;
+	frameNsecs=frameNsecsMax=tracksNsecs=0;
+	lastFrameStats=0;
+	frameClock.start();
 	
 	lastSkyUpdate = QDateTime::currentDateTime();
 	lastSkyUpdate = lastSkyUpdate.addSecs(-999);
 	skyUpdateInterval=60;
 	
-	receiverLabel=NULL;
+	sprites=NULL;
+	text=NULL;
+	labelFont=0;
 	
 	naz=90;
 	nel=90;
-	skyColour = new Colour*[(nel+1)*(naz+1)];
-	for (int i=0;i<(nel+1)*(naz+1);i++)
-		skyColour[i]=new Colour();
+	skyRGB.fill(0.0,3*naz*(nel+1)); // black, until there's a sky
 	
 	sideMargin=0.03; // margin at the sides
 	barMargin=0.003; // separation between bars
@@ -110,6 +136,12 @@ GNSSViewWidget::GNSSViewWidget(QWidget *parent,QList<GNSSSV *> *b):QGLWidget(par
 
 GNSSViewWidget::~GNSSViewWidget()
 {
+	logFrameStatistics();
+	makeCurrent(); // for deleting the vertex buffers
+	qDeleteAll(trackBuffers);
+	delete text;
+	delete coverageBuffer;
+	delete sprites;
 	delete sunModel;
 	delete skyModel;
 }
@@ -138,16 +170,25 @@ void GNSSViewWidget::setReceiver(QString r){
 	receiver=r;
 }
 
-void GNSSViewWidget::setAnimation(int framesPerSecond,double rotationalPeriod,int skyUpdate, bool smoothTracks){
+void GNSSViewWidget::setAnimation(int framesPerSecond,double rotationalPeriod,int skyUpdate){
 	fps=framesPerSecond;
 	trot=rotationalPeriod;
 	dphi=360.0/(fps*trot);
 	skyUpdateInterval=skyUpdate;
-	smooth=smoothTracks;
+}
+
+// Shows the archived tracks for the span (in seconds, 0 for none) before the time the tracks are shown at.
+// The archive is also where satellites no longer tracked are found, when showing an earlier time.
+
+void GNSSViewWidget::setArchive(TrackArchive *a,int span)
+{
+	archive=a;
+	coverageSpan=span;
+	coverageRevision=-1; // rebuild it
 }
 
 void GNSSViewWidget::setConstellationActive(int c){
-	constellations.at(c)->active=true;
+	constellations.at(c)->setActive(true);
 }
 
 //
@@ -162,6 +203,7 @@ void GNSSViewWidget::animate()
 		phi0-=360.0;
 		phi1=phi0+fov;
 	}
+	emit aboutToRender();
 	updateGL();
 	animationTimer->start(1000.0/fps);
 }
@@ -172,6 +214,13 @@ void GNSSViewWidget::update(QDateTime &)
 	//updateGL();
 }
 
+// Called once per epoch applied to the satellites, rather than once per observation
+
+void GNSSViewWidget::epochCommitted()
+{
+	tracksChanged=true;
+}
+
 void GNSSViewWidget::toggleForeground()
 {
 	showForeground=!showForeground;
@@ -188,6 +237,17 @@ void GNSSViewWidget::offsetTime(int hours)
 	updateGL();
 }
 
+// Shows the tracks as they were at time t (UNIX time), or the latest if t is 0.
+// The sun and sky are shown as they were then too, still offset by tOffset.
+
+void GNSSViewWidget::showTracksAt(int t)
+{
+	trackTime = t;
+	tracksChanged=true;
+	lastSkyUpdate = QDateTime::currentDateTime().addSecs(-999); // for a new sky image
+	updateGL();
+}
+
 
 //
 // Protected methods
@@ -260,16 +320,47 @@ void GNSSViewWidget::initializeGL()
 	
 	glDisable(GL_TEXTURE_2D);
 	
+	// The daytime sky. The colours wrap in azimuth.
+	glGenTextures(1,&skytex);
+	glBindTexture(GL_TEXTURE_2D,skytex);
+	glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, naz, nel+1, 0,
+      GL_RGB, GL_FLOAT, skyRGB.constData());
+	glBindTexture(GL_TEXTURE_2D,0);
+	
+	CHECK_GLERROR();
+	
+	if (vertexBuffers)
+		trackProgram = TrackBuffer::makeProgram(this);
+	else
+		qInfo() << "GNSSViewWidget: tracks are drawn in immediate mode, as configured";
+	
+	coverageBuffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+	coverageBuffer->setUsagePattern(QGLBuffer::DynamicDraw);
+	if (!coverageBuffer->create()){
+		qWarning() << "GNSSViewWidget: no vertex buffer for the coverage, so it is drawn from client memory";
+		delete coverageBuffer;
+		coverageBuffer=NULL;
+	}
+	
 	initTextures();
 
 }
 
 void 	GNSSViewWidget::paintGL()
 {
+	QElapsedTimer frameTimer;
+	frameTimer.start();
+	frameNumber++;
+	
 	if (animatedSky){
 		QDateTime now=QDateTime::currentDateTime();
 		if (lastSkyUpdate.secsTo(now) > skyUpdateInterval){ // calculate a new sky model
-			QDateTime utc = now.toUTC();
+			QDateTime utc = (trackTime != 0 ? QDateTime::fromTime_t(trackTime) : now).toUTC(); // as the tracks are shown
 			utc=utc.addSecs(tOffset*3600);
 			sunModel->update(utc.date().year(),utc.date().month(),utc.date().day()
 				,utc.time().hour(),utc.time().minute(),utc.time().second());
@@ -277,14 +368,20 @@ void 	GNSSViewWidget::paintGL()
 			sunModel->position(&az,&el);
 			if (el>-7){
 				skyModel->setSolarPosition(az,el);
+				GLfloat *rgb = skyRGB.data();
 				for (int j=0;j<=nel;j++){
-					for (int i=0;i<=naz;i++){
+					for (int i=0;i<naz;i++){ // 360 is the same as 0
 						az=((double) i/ (double) naz)*360.0;						
 						Colour c = skyModel->colour(az,90.0*j/nel);
 						Colour cg = c.gammaCorrect(gammaCorrection_);
-						*skyColour[j*naz+i]=cg;
+						*rgb++ = cg.x;
+						*rgb++ = cg.y;
+						*rgb++ = cg.z;
 					}
 				}
+				glBindTexture(GL_TEXTURE_2D,skytex);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, naz, nel+1, GL_RGB, GL_FLOAT, skyRGB.constData());
+				glBindTexture(GL_TEXTURE_2D,0);
 			}
 			lastSkyUpdate=now;
 		}
@@ -312,14 +409,26 @@ void 	GNSSViewWidget::paintGL()
 		drawSky();
 		drawSun();
 	}
+	drawCoverage();
   drawBirds();
+	tracksChanged=false;
+	drawSprites(); // the satellite icons and labels, under the foreground
 	if (showForeground) drawForeground();
 	if (signalLevels) drawSignalBars();
 	drawInfo();
 	if (gridOn) drawGrid();
+	drawSprites();
 	
 	glPopMatrix();
 	
+	qint64 t = frameTimer.nsecsElapsed();
+	nFrames++;
+	frameNsecs += t;
+	if (t > frameNsecsMax) frameNsecsMax=t;
+	if (frameClock.elapsed() - lastFrameStats >= FRAME_STATS_INTERVAL*1000){
+		logFrameStatistics();
+		lastFrameStats=frameClock.elapsed();
+	}
 }
 
 void 	GNSSViewWidget::resizeGL( int w, int h )
@@ -376,28 +485,17 @@ void 	GNSSViewWidget::drawGrid()
 	
 	glMatrixMode(GL_MODELVIEW);
 	
-	glEnable (GL_BLEND); 
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_TEXTURE_2D);
-	
+	const char *compass[4]={"N","E","S","W"};
 	for (int i=0;i<4;i++){
-		glPushMatrix();
 		double x0=i*90;
 		if (phi1>360 && x0+360<phi1)
 			x0+=360;
-		glTranslatef( (x0-phi0)/fov*(width()-1)- compassLabels[i]->w/2.0,(1.0-0.03)*height()-1-compassLabels[i]->h,0);
-		compassLabels[i]->paint();
-		glPopMatrix();
+		text->addText(labelFont,compass[i],(x0-phi0)/fov*(width()-1)- text->width(labelFont,compass[i])/2.0,
+			(1.0-0.03)*height()-1-text->height(labelFont));
 	}
 	
 	CHECK_GLERROR();
 	
-	glBindTexture(GL_TEXTURE_2D,0);
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_BLEND);
-	
-	CHECK_GLERROR();
-	
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	gluOrtho2D(phi0,phi1,minElevation,EL1);
@@ -407,12 +505,6 @@ void 	GNSSViewWidget::drawGrid()
 
 void GNSSViewWidget::drawInfo()
 {
-	if (receiverLabel==NULL){
-		QFont f;
-		f.setPointSize(18);
-		receiverLabel=new GLText(this,receiver,f);
-	}
-	
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	gluOrtho2D(0,width()-1,0,height()-1);
@@ -446,56 +538,43 @@ void GNSSViewWidget::drawSky()
 		glPushAttrib(GL_POLYGON_BIT);
 		glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
 		
-		if (el <= -7) // nighttime
-		{
-			glEnable(GL_TEXTURE_2D);
+		// Night and day are both one textured quad, so the transition is just a change of texture
+		double s0,s1,t0,t1;
+		glEnable(GL_TEXTURE_2D);
+		if (el <= -7){ // nighttime
 			glBindTexture(GL_TEXTURE_2D,nighttex);
-	
-			glBegin(GL_QUADS);
-			double imsf=1.0/360.0;
-
-			glTexCoord2f(phi0*imsf+0.5,0);
-			glVertex2f(phi0,0);
-	
-			glTexCoord2f(phi1*imsf+0.5,0);
-			glVertex2f(phi1,0);
-	
-			glTexCoord2f(phi1*imsf+0.5,1.0);
-			glVertex2f(phi1,EL1);
-	
-			glTexCoord2f(phi0*imsf+0.5,1.0);
-			glVertex2f(phi0,EL1);
-			glEnd();
-			
-			glDisable(GL_TEXTURE_2D);
-			glBindTexture(GL_TEXTURE_2D,0);
-			
+			s0 = phi0/360.0+0.5;
+			s1 = phi1/360.0+0.5;
+			t0 = 0.0;
+			t1 = 1.0;
 		}
 		else{
-		
-			double dd = rint(360.0/naz);
-
-			int irphi0=floor(phi0/dd);	
-			int irphi1=ceil(phi1/dd);
-			
-			for (int j=0;j<nel;j++){
-				el = (double) j/ (double) nel;
-				double elp1 = (j+1.0)/nel;
-				glBegin(GL_TRIANGLE_STRIP);
-				for (int i=irphi0;i<=irphi1;i++)
-				{
-					double phi=i*dd;
-					int indx = i % naz; 
-					Colour *c= skyColour[(j+1)*naz+indx];
-					glColor3f(c->x,c->y,c->z);
-					glVertex2f(phi,elp1*90);
-					c= skyColour[j*naz+indx];
-					glColor3f(c->x,c->y,c->z);
-					glVertex2f(phi,el*90);
-				}
-				glEnd();
-			}
+			// texel centres lie on the grid the sky model was evaluated on
+			glBindTexture(GL_TEXTURE_2D,skytex);
+			s0 = phi0/360.0+0.5/naz;
+			s1 = phi1/360.0+0.5/naz;
+			t0 = 0.5/(nel+1);
+			t1 = (nel+0.5)/(nel+1);
 		}
+	
+		glBegin(GL_QUADS);
+
+		glTexCoord2f(s0,t0);
+		glVertex2f(phi0,0);
+
+		glTexCoord2f(s1,t0);
+		glVertex2f(phi1,0);
+
+		glTexCoord2f(s1,t1);
+		glVertex2f(phi1,EL1);
+
+		glTexCoord2f(s0,t1);
+		glVertex2f(phi0,EL1);
+		glEnd();
+		
+		glDisable(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D,0);
+		
 		glPopAttrib();
 	}
 	else{ // flat colour
@@ -596,6 +675,111 @@ void GNSSViewWidget::drawForeground()
 	glDisable(GL_BLEND);
 }
 
+// Faint tracks of the satellites over the span before the time shown, from the archive.
+// The lines are built into a vertex buffer, which is rebuilt only when the archive has been written to
+// or the time shown has changed, so each frame is a draw call for each turn in view.
+
+void GNSSViewWidget::drawCoverage()
+{
+	if (!archive || coverageSpan <= 0) return;
+	
+	if (archive->revision != coverageRevision || trackTime != coverageTime)
+		buildCoverage();
+	if (coverageVertices == 0) return;
+	
+	glEnable(GL_LINE_SMOOTH);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+	glLineWidth(2.0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	const char *v = (const char *) coverageLines.constData();
+	if (coverageBuffer){
+		coverageBuffer->bind();
+		v = NULL; // offsets into the buffer
+	}
+	glVertexPointer(2,GL_FLOAT,6*sizeof(GLfloat),v);
+	glColorPointer(4,GL_FLOAT,6*sizeof(GLfloat),v+2*sizeof(GLfloat));
+	for (int turn=0;turn<=1;turn++){ // the view can extend past 360
+		float offset=360.0*turn;
+		if (coverageAzMax+offset < phi0 || coverageAzMin+offset > phi1)
+			continue;
+		glPushMatrix();
+		glTranslatef(offset,0,0);
+		glDrawArrays(GL_LINES,0,coverageVertices);
+		glPopMatrix();
+	}
+	if (coverageBuffer)
+		coverageBuffer->release();
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glLineWidth(1.0);
+	glDisable(GL_LINE_SMOOTH);
+	glDisable(GL_BLEND);
+	
+	CHECK_GLERROR();
+}
+
+// Makes the coverage lines from the archive: a segment between each pair of consecutive records of a satellite.
+// The level of detail is chosen so that the number of records drawn is about the same, whatever the span.
+
+void GNSSViewWidget::buildCoverage()
+{
+	coverageRevision = archive->revision;
+	coverageTime = trackTime;
+	coverageVertices=0;
+	coverageLines.resize(0);
+	coverageAzMin=coverageAzMax=0.0;
+	
+	int to = (trackTime != 0 ? trackTime : QDateTime::currentDateTime().toTime_t());
+	int from = to - coverageSpan;
+	int level = archive->level(from,to,ARCHIVE_POINT_BUDGET);
+	int n;
+	const ArchiveRecord *r = archive->records(level,from,to,&n);
+	if (n == 0) return;
+	int maxGap = 2*TrackArchive::bucket(level); // otherwise, it's a different pass
+	
+	int last[ARCHIVE_SLOTS]; // the previous record of each satellite
+	for (int s=0;s<ARCHIVE_SLOTS;s++)
+		last[s]=-1;
+	
+	coverageAzMin=360.0;
+	coverageAzMax=0.0;
+	for (int i=0;i<n;i++){
+		int c = r[i].constellation;
+		int slot = c*ARCHIVE_MAX_PRN + r[i].PRN;
+		int j = last[slot];
+		last[slot]=i;
+		if (j < 0 || r[i].time - r[j].time > maxGap || c >= constellations.size())
+			continue;
+		float a0 = 0.01*r[j].az, e0 = 0.01*r[j].elev;
+		float a1 = 0.01*r[i].az, e1 = 0.01*r[i].elev;
+		if (a1 - a0 > 180.0) a1 -= 360.0; // continuous across north
+		else if (a1 - a0 < -180.0) a1 += 360.0;
+		const GLfloat *col = constellations[c]->histColour;
+		GLfloat seg[12] = {a0,e0,col[0],col[1],col[2],COVERAGE_ALPHA, a1,e1,col[0],col[1],col[2],COVERAGE_ALPHA};
+		for (int k=0;k<12;k++)
+			coverageLines.append(seg[k]);
+		coverageAzMin = qMin(coverageAzMin,qMin(a0,a1));
+		coverageAzMax = qMax(coverageAzMax,qMax(a0,a1));
+	}
+	coverageVertices = coverageLines.size()/6;
+	
+	if (!coverageBuffer) return;
+	coverageBuffer->bind();
+	coverageBuffer->allocate(coverageLines.constData(),coverageLines.size()*sizeof(GLfloat));
+	coverageBuffer->release();
+}
+
+// The number of points of the satellite's track which are shown, at the time the tracks are shown at
+
+int GNSSViewWidget::pointsShown(GNSSSV *sv)
+{
+	if (trackTime == 0)
+		return sv->track.size();
+	return sv->track.pointsAt(trackTime);
+}
+
 void GNSSViewWidget::drawBirds()
 {
 	
@@ -605,68 +789,11 @@ void GNSSViewWidget::drawBirds()
 	glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
 	glLineWidth(5.0);
 	
-	for (int i=0;i<birds->size();++i){
-		//if (birds->at(i)->PRN !=10)
-		//	continue;
-		//qDebug()<< "###";
-		int c = birds->at(i)->constellation;
-		// Could filter out birds which are not visible but this looks a bit icky visually because they and their trails
-		// will pop in and out. So we won't do that.
-	
-		int npts=birds->at(i)->az.size(); // guaranteed non-zero
-		double deltaAlpha=0.9;
-		if (npts != 1)
-			deltaAlpha /= (npts-1.0);
-		
-		int jdrop=npts; // need to track dropped points so that they're not included ?
-		bool dropping=true; // to catch the first point
-		
-		for (int j=npts-1;j>=0;j--){
-			
-			double el;
-			double az =  birds->at(i)->az[j];
-			
-			if (phi1 > 360 &&  az+360 < phi1)
-				az+=360.0;
-			if (!(az >=phi0 && az<=phi1)){ // point not visible so skip it
-				jdrop=j;
-				if (!dropping){
-					dropping=true;
-					glEnd(); // of the GL_LINE_STRIP
-				}
-				continue;
-			}
-			
-			glColor4f(constellations[c]->histColour[0],constellations[c]->histColour[1],constellations[c]->histColour[2],0.1+j*deltaAlpha);
-			
-			if (dropping){ // resume drawing
-				dropping=false;
-				glBegin(GL_LINE_STRIP);
-				//qDebug() << az << " " << birds->at(i)->elev[j] << " " << phi0 << " " << phi1 << "1";
-				glVertex2f(az,birds->at(i)->elev[j]);
-				continue;
-			}
-			
-			el=birds->at(i)->elev[j];
-			
-			if (smooth && j<= jdrop-3){ // can smooth ...
-				double az1 =  birds->at(i)->az[j+1];
-				if (phi1 > 360 &&  az1+360 < phi1)
-					az1+=360.0;
-				double az2 =  birds->at(i)->az[j+2];
-				if (phi1 > 360 &&  az2+360 < phi1)
-					az2+=360.0;
-				az= (az+az1+az2)/3.0;
-				el=(birds->at(i)->elev[j]+ birds->at(i)->elev[j+1]+ birds->at(i)->elev[j+2])/3.0;
-				//qDebug() << az << " " << birds->at(i)->elev[j] << " " << phi0 << " " << phi1 << "2";
-			}
-			//else
-				//qDebug() << az << " " << birds->at(i)->elev[j] << " " << phi0 << " " << phi1 << "3";
-			glVertex2f(az,el);
-		
-		}
-		if(!dropping) glEnd(); // finish the line
-	}
+	QElapsedTimer tracksTimer;
+	tracksTimer.start();
+	drawTracks();
+	drawPastTracks();
+	tracksNsecs += tracksTimer.nsecsElapsed();
 	
 	glDisable(GL_LINE_SMOOTH);
 	glLineWidth(1.0);
@@ -681,59 +808,15 @@ void GNSSViewWidget::drawBirds()
 	
 	glMatrixMode(GL_MODELVIEW);
 	
-	glEnable(GL_TEXTURE_2D);
-	glBindTexture(GL_TEXTURE_2D,sattex);
-	CHECK_GLERROR();
-	glPushMatrix();
-	glBegin(GL_QUADS);
 	for (int i=0;i<birds->size();++i){
-		int sz = birds->at(i)->az.size() -1 ;
-		GLfloat x0 =  birds->at(i)->az[sz];
-		if (phi1 > 360 &&  x0+360 < phi1)
-			x0+=360.0;
-		GLfloat x=(x0-phi0)/fov*(width()-1)-satWidth/2.0;
-		GLfloat y=(birds->at(i)->elev[sz]-minElevation)/(EL1-minElevation)*(height()-1)-satHeight/2.0;
-		
-		glTexCoord2f(0,0);
-		glVertex2f(x,y);
-
-		glTexCoord2f(1.0,0);
-		glVertex2f(x+satWidth-1,y);
-
-		glTexCoord2f(1.0,1.0);
-		glVertex2f(x+satWidth-1,y+satHeight-1);
-
-		glTexCoord2f(0,1.0);
-		glVertex2f(x,y+satHeight-1);
-		
+		int shown = pointsShown(birds->at(i));
+		if (shown == 0)
+			continue;
+		addSatellite(birds->at(i)->constellation,birds->at(i)->PRN,birds->at(i)->track.az(shown-1),birds->at(i)->track.elev(shown-1));
 	}
-	glEnd();
-	glPopMatrix();
-	
-	CHECK_GLERROR();
-	
-	glBindTexture(GL_TEXTURE_2D,0);
+	for (int i=0;i<pastSatellites.size()/2;i++)
+		addSatellite(pastSatellites.at(2*i),pastSatellites.at(2*i+1),pastPositions.at(2*i),pastPositions.at(2*i+1));
 	
-	for (int i=0;i<birds->size();++i){
-		int sz = birds->at(i)->az.size() -1 ;
-		GLfloat phi =  birds->at(i)->az[sz];
-		if (phi1 > 360 &&  phi+360 < phi1)
-			phi+=360.0;
-		int x=(phi-phi0)/fov*(width()-1)+satWidth/2.0;
-		//if (x > width()-1 -usiLabel[birds->at(i)->PRN]->w)
-		//	x=(birds->at(i)->az[sz]-phi0)/fov*(width()-1)-satWidth/2.0-usiLabel[birds->at(i)->PRN]->w;
-		ConstellationProperties *cprop=constellations.at(birds->at(i)->constellation);
-		GLText *svLabel = cprop->svLabels.at(birds->at(i)->PRN-cprop->svIDmin);
-		int y=(birds->at(i)->elev[sz]-minElevation)/(EL1-minElevation)*(height()-1)-svLabel->h/2.0;
-		if (y>height()-1 -svLabel->h)
-			y-=svLabel->h/2.0;
-		
-		glPushMatrix();
-		glTranslatef(x,y,0);
-		svLabel->paint();
-		glPopMatrix();
-	}
-	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_BLEND);
 	
 	CHECK_GLERROR();
@@ -745,6 +828,206 @@ void GNSSViewWidget::drawBirds()
 	glMatrixMode(GL_MODELVIEW);
 }
 
+// Queues the icon and label of a satellite at (az,el)
+
+void GNSSViewWidget::addSatellite(int c,int prn,float az,float el)
+{
+	GLfloat phi = az;
+	if (phi1 > 360 &&  phi+360 < phi1)
+		phi+=360.0;
+	GLfloat x=(phi-phi0)/fov*(width()-1)-satWidth/2.0;
+	GLfloat y=(el-minElevation)/(EL1-minElevation)*(height()-1)-satHeight/2.0;
+	sprites->add(sattex,x,y,x+satWidth-1,y+satHeight-1);
+	
+	int lx=(phi-phi0)/fov*(width()-1)+satWidth/2.0;
+	int h = text->height(labelFont);
+	int ly=(el-minElevation)/(EL1-minElevation)*(height()-1)-h/2.0;
+	if (ly>height()-1 -h)
+		ly-=h/2.0;
+	text->addText(labelFont,constellations.at(c)->idLabel+QString::number(prn),lx,ly);
+}
+
+// When the tracks are shown at an earlier time, satellites which have expired since then are no longer 
+// in the table, so their passes are drawn from the archive, fading with age as the live tracks do.
+
+void GNSSViewWidget::drawPastTracks()
+{
+	if (trackTime == 0 || !archive){
+		if (pastTime != -1){
+			pastTime=-1;
+			pastLines.resize(0);
+			pastSatellites.resize(0);
+			pastPositions.resize(0);
+		}
+		return;
+	}
+	if (archive->revision != pastRevision || trackTime != pastTime || tracksChanged)
+		buildPastTracks();
+	if (pastLines.isEmpty()) return;
+	
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2,GL_FLOAT,6*sizeof(GLfloat),pastLines.constData());
+	glColorPointer(4,GL_FLOAT,6*sizeof(GLfloat),pastLines.constData()+2);
+	for (int turn=0;turn<=1;turn++){
+		float offset=360.0*turn;
+		if (pastAzMax+offset < phi0 || pastAzMin+offset > phi1)
+			continue;
+		glPushMatrix();
+		glTranslatef(offset,0,0);
+		glDrawArrays(GL_LINES,0,pastLines.size()/6);
+		glPopMatrix();
+	}
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// Follows each satellite in the archive back from the time shown, until its pass began or PAST_TRACK_SPAN.
+// Satellites which weren't in view then, or whose live track covers the time, are left out.
+
+void GNSSViewWidget::buildPastTracks()
+{
+	pastRevision = archive->revision;
+	pastTime = trackTime;
+	pastLines.resize(0);
+	pastSatellites.resize(0);
+	pastPositions.resize(0);
+	pastAzMin=pastAzMax=0.0;
+	
+	int from = trackTime - PAST_TRACK_SPAN;
+	int level = archive->level(from,trackTime,ARCHIVE_POINT_BUDGET);
+	int n;
+	const ArchiveRecord *r = archive->records(level,from,trackTime,&n);
+	if (n == 0) return;
+	int maxGap = 2*TrackArchive::bucket(level); // otherwise, it's a different pass
+	
+	int next[ARCHIVE_SLOTS]; // the following record of each satellite, -1 if there's none yet, -2 once it's done with
+	for (int s=0;s<ARCHIVE_SLOTS;s++)
+		next[s]=-1;
+	
+	pastAzMin=360.0;
+	pastAzMax=0.0;
+	for (int i=n-1;i>=0;i--){
+		int c = r[i].constellation;
+		int slot = c*ARCHIVE_MAX_PRN + r[i].PRN;
+		int j = next[slot];
+		if (j == -2 || c >= constellations.size())
+			continue;
+		if (j == -1){ // the latest record
+			GNSSSV *sv = birds->find(c,r[i].PRN);
+			if (trackTime - r[i].time > maxGap || (sv && pointsShown(sv) > 0)){
+				next[slot]=-2;
+				continue;
+			}
+			next[slot]=i;
+			pastSatellites.append(c);
+			pastSatellites.append(r[i].PRN);
+			pastPositions.append(0.01*r[i].az);
+			pastPositions.append(0.01*r[i].elev);
+			continue;
+		}
+		if (r[j].time - r[i].time > maxGap){ // the start of the pass
+			next[slot]=-2;
+			continue;
+		}
+		next[slot]=i;
+		float a0 = 0.01*r[i].az, e0 = 0.01*r[i].elev;
+		float a1 = 0.01*r[j].az, e1 = 0.01*r[j].elev;
+		if (a1 - a0 > 180.0) a1 -= 360.0; // continuous across north
+		else if (a1 - a0 < -180.0) a1 += 360.0;
+		float f0 = 0.1 + 0.9*(1.0 - (float) (trackTime - r[i].time)/PAST_TRACK_SPAN);
+		float f1 = 0.1 + 0.9*(1.0 - (float) (trackTime - r[j].time)/PAST_TRACK_SPAN);
+		const GLfloat *col = constellations[c]->histColour;
+		GLfloat seg[12] = {a0,e0,col[0],col[1],col[2],f0, a1,e1,col[0],col[1],col[2],f1};
+		for (int k=0;k<12;k++)
+			pastLines.append(seg[k]);
+		pastAzMin = qMin(pastAzMin,qMin(a0,a1));
+		pastAzMax = qMax(pastAzMax,qMax(a0,a1));
+	}
+}
+
+// Draws the tracks from vertex buffers, one draw call for each track, falling back to immediate mode 
+// when there are no shaders. The vertex buffers are updated after each epoch.
+
+void GNSSViewWidget::drawTracks()
+{
+	if (trackProgram)
+		trackProgram->bind();
+	
+	for (int i=0;i<birds->size();++i){
+		GNSSSV *sv = birds->at(i);
+		int c = sv->constellation;
+		// Could filter out birds which are not visible but this looks a bit icky visually because they and their trails
+		// will pop in and out. So we won't do that.
+	
+		int shown = pointsShown(sv);
+		if (shown == 0) // not seen yet, at the time shown
+			continue;
+		int npts=sv->geometry.vertices(shown);
+		const float *colour = constellations[c]->histColour;
+		
+		// Azimuth is continuous, so the track is drawn whole, shifted by a turn as needed
+		// to put it in the view. Clipping takes care of the parts which aren't visible.
+		
+		if (trackProgram){
+			TrackBuffer *tb = trackBuffers.value(sv,NULL);
+			if (!tb){
+				tb = new TrackBuffer();
+				trackBuffers.insert(sv,tb);
+				tb->update(sv->geometry);
+			}
+			else if (tracksChanged)
+				tb->update(sv->geometry);
+			tb->frame=frameNumber;
+			trackProgram->setUniformValue("colour",colour[0],colour[1],colour[2]);
+			for (int turn=-1;turn<=1;turn++){
+				float offset=360.0*turn;
+				if (tb->azMax+offset < phi0 || tb->azMin+offset > phi1)
+					continue;
+				tb->draw(trackProgram,sv->geometry,npts,offset);
+			}
+			continue;
+		}
+		
+		const float *gaz = sv->geometry.az();
+		const float *gel = sv->geometry.elev();
+		double deltaAlpha=0.9;
+		if (npts != 1)
+			deltaAlpha /= (npts-1.0);
+		float azmin=gaz[0],azmax=gaz[0];
+		for (int j=1;j<npts;j++){
+			if (gaz[j] < azmin) azmin=gaz[j];
+			else if (gaz[j] > azmax) azmax=gaz[j];
+		}
+		for (int turn=-1;turn<=1;turn++){
+			float offset=360.0*turn;
+			if (azmax+offset < phi0 || azmin+offset > phi1)
+				continue;
+			glBegin(GL_LINE_STRIP);
+			for (int j=0;j<npts;j++){
+				glColor4f(colour[0],colour[1],colour[2],0.1+j*deltaAlpha);
+				glVertex2f(gaz[j]+offset,gel[j]);
+			}
+			glEnd();
+		}
+	}
+	
+	if (!trackProgram)
+		return;
+	trackProgram->release();
+	
+	// the buffers of satellites which have gone
+	QHash<GNSSSV *,TrackBuffer *>::iterator it = trackBuffers.begin();
+	while (it != trackBuffers.end()){
+		if (it.value()->frame != frameNumber){
+			delete it.value();
+			it = trackBuffers.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
 void GNSSViewWidget::drawSignalBars()
 {
 	
@@ -766,60 +1049,49 @@ void GNSSViewWidget::drawSignalBars()
 	int cnt=0;
 	GLfloat *col;
 	
-	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++)
-		constellations[c]->svcnt=0;
-	
-	// signal bars
-	for (int i=0;i<birds->size();++i){
-		int c = birds->at(i)->constellation;
-		double sn = signalHeight*birds->at(i)->sn; // prescaled [0,1]
-		
-		constellations[c]->svcnt++;
-		cnt=constellations[c]->svcnt;
-		if (cnt > constellations[c]->maxsv) continue;
-		
-		col = constellations[c]->histColour;
-		double x0=(constellations[c]->x0+(cnt-1)*barWidth + (cnt-1)*barMargin)*(width()-1.0);
-		double y0= voffset*(height()-1);
-		
-		glDisable(GL_BLEND);
-		glBegin(GL_POLYGON);
-		glColor4f(col[0]*0.5,col[1]*0.5,col[2]*0.5,col[3]);
-		glVertex2f(x0,y0);
-		glVertex2f(x0+barWidth*(width()-1),y0);
-		glColor4fv(col);
-		glVertex2f(x0+barWidth*(width()-1),y0+sn);
-		glVertex2f(x0,y0+sn);
-		glEnd();
-		glEnable(GL_BLEND);
+	// signal bars, in order of PRN, found by looking them up since the table's lists aren't in order
+	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
+		ConstellationProperties *cprop=constellations.at(c);
+		cprop->svcnt=birds->members(c).size();
+		col = cprop->histColour;
 		
-		glEnable(GL_TEXTURE_2D);
-		glPushMatrix();
-		ConstellationProperties *cprop=constellations.at(birds->at(i)->constellation);
-		GLText *svLabel = cprop->svLabels.at(birds->at(i)->PRN-cprop->svIDmin);
-		glTranslatef(x0+(barWidth*(width()-1)+ svLabel->ascent)/2.0-3,y0+6,0); // fudge here
-		glRotatef(90,0,0,1);
-		svLabel->paint();
-		glPopMatrix();
-		glDisable(GL_TEXTURE_2D);
-	
+		int nbars = qMin(cprop->svcnt,cprop->maxsv);
+		int i=0;
+		for (int prn=cprop->svIDmin;prn<=cprop->svIDmax && i<nbars;prn++){
+			GNSSSV *sv = birds->find(c,prn);
+			if (!sv)
+				continue;
+			double sn = signalHeight*sv->sn; // prescaled [0,1]
+			
+			cnt=++i;
+			double x0=(cprop->x0+(cnt-1)*barWidth + (cnt-1)*barMargin)*(width()-1.0);
+			double y0= voffset*(height()-1);
+			
+			glDisable(GL_BLEND);
+			glBegin(GL_POLYGON);
+			glColor4f(col[0]*0.5,col[1]*0.5,col[2]*0.5,col[3]);
+			glVertex2f(x0,y0);
+			glVertex2f(x0+barWidth*(width()-1),y0);
+			glColor4fv(col);
+			glVertex2f(x0+barWidth*(width()-1),y0+sn);
+			glVertex2f(x0,y0+sn);
+			glEnd();
+			glEnable(GL_BLEND);
+			
+			text->addText(labelFont,cprop->idLabel+QString::number(sv->PRN),
+				x0+(barWidth*(width()-1)+ text->ascent(labelFont))/2.0-3,y0+6,true); // fudge here
+		}
 	}
 	
 	// constellation names
-	glEnable(GL_TEXTURE_2D);
 	double y0=voffset*(height()-1);
 	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
-		if (constellations[c]->active){
-			glPushMatrix();
-			double x0=constellations[c]->x0*(width()-1)-2*constellations[c]->GLlabel->descent; // good enough
-			glTranslatef(x0,y0,0);
-			glRotatef(90,0,0,1);
-			constellations[c]->GLlabel->paint();
-			glPopMatrix();
+		if (constellations[c]->isActive()){
+			double x0=constellations[c]->x0*(width()-1)-2*text->descent(labelFont); // good enough
+			text->addText(labelFont,constellations[c]->label,x0,y0,true);
 		}
 	}
 	
-	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_BLEND);
 	
 	CHECK_GLERROR();
@@ -831,26 +1103,49 @@ void GNSSViewWidget::drawSignalBars()
 	glMatrixMode(GL_MODELVIEW);
 }
 
+// The icons and text queued since the last time, in a draw call for each texture.
+// Called once before the foreground is drawn, and again at the end of the frame.
+
+void GNSSViewWidget::drawSprites()
+{
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	gluOrtho2D(0,width()-1,0,height()-1);
+	
+	glMatrixMode(GL_MODELVIEW);
+	glEnable(GL_BLEND);
+	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	
+	sprites->draw();
+	
+	glDisable(GL_BLEND);
+	
+	CHECK_GLERROR();
+	
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	gluOrtho2D(phi0,phi1,minElevation,EL1);
+	
+	glMatrixMode(GL_MODELVIEW);
+}
+
+void GNSSViewWidget::logFrameStatistics()
+{
+	if (nFrames == 0) return;
+	qInfo() << "frames:" << nFrames << " mean CPU time=" << frameNsecs/nFrames/1000 << "us max=" << frameNsecsMax/1000 
+		<< "us tracks=" << tracksNsecs/nFrames/1000 << "us" << (trackProgram ? "(vertex buffers)" : "(immediate mode)");
+	nFrames=0;
+	frameNsecs=frameNsecsMax=tracksNsecs=0;
+}
+
 void GNSSViewWidget::initTextures(){
 	QFont f;
-	f.setPointSize(18);
-
 	f.setPointSize(20);
 	
-	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
-		ConstellationProperties *cprop= constellations[c];
-		cprop->GLlabel= new GLText(this,cprop->label,f);
-		for (int i=cprop->svIDmin;i<=cprop->svIDmax;i++){
-			QString txt = cprop->idLabel+QString::number(i);
-			GLText *glt = new GLText(this,txt,f);
-			cprop->svLabels.append(glt);	
-		}
-	}	
-	
-	compassLabels.append(new GLText(this,"N",f));
-	compassLabels.append(new GLText(this,"E",f));
-	compassLabels.append(new GLText(this,"S",f));
-	compassLabels.append(new GLText(this,"W",f));
+	// labels are made from the atlas as they're needed
+	sprites = new SpriteBatch();
+	text = new GlyphAtlas(this,sprites);
+	labelFont = text->addFont(f);
 }
 
 void GNSSViewWidget::initLayout(){
@@ -863,7 +1158,7 @@ void GNSSViewWidget::initLayout(){
 	// determine horizontal space for each signal bar
 	int nconst=0;
 	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
-		if (constellations.at(c)->active){
+		if (constellations.at(c)->isActive()){
 			maxsats += constellations.at(c)->maxsv;
 			nconst++;
 		}
@@ -877,7 +1172,7 @@ void GNSSViewWidget::initLayout(){
 	}
 	
 	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
-		if (constellations.at(c)->active){
+		if (constellations.at(c)->isActive()){
 			constellations.at(c)->x0=x0;
 			x0+=constellationNameSpc+constellations.at(c)->maxsv*barWidth+(constellations.at(c)->maxsv-1)*barMargin+constellationMargin;
 		}
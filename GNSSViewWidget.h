@@ -28,16 +28,24 @@
 #define __GNSS_VIEW_WIDGET_H_
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QGLWidget>
+#include <QHash>
 #include <QString>
+#include <QVector>
 
 class ConstellationProperties;
-class Colour;
 class Sun;
 class SkyModel;
-class GLText;
+class GlyphAtlas;
+class SpriteBatch;
 class GNSSSV;
+class SatelliteTable;
+class TrackArchive;
+class TrackBuffer;
 
+class QGLBuffer;
+class QGLShaderProgram;
 class QTimer;
 
 class GNSSViewWidget: public QGLWidget
@@ -46,22 +54,30 @@ class GNSSViewWidget: public QGLWidget
 
 	public:
 		
-		GNSSViewWidget(QWidget *parent=0,QList<GNSSSV *> *b=NULL);
+		GNSSViewWidget(QWidget *parent=0,SatelliteTable *b=NULL);
 		~GNSSViewWidget();
 		
 		void setForegroundImage(QString,double,double);
 		void setNightSkyImage(QString);
 		void setLocation(double,double);
 		void setReceiver(QString);
-		void setAnimation(int,double,int,bool);
+		void setAnimation(int,double,int);
 		void setConstellationActive(int);
+		void setArchive(TrackArchive *,int);
+		void setVertexBuffers(bool on){vertexBuffers=on;} // before the widget is shown
+		
+	signals:
+	
+		void aboutToRender();
 		
 	public slots:
 		
 		void update(QDateTime &);
+		void epochCommitted();
 		
 		void toggleForeground();
 		void offsetTime(int);
+		void showTracksAt(int);
 		
 	protected:
 
@@ -82,15 +98,51 @@ class GNSSViewWidget: public QGLWidget
 		void drawSky();
 		void drawSun();
 		void drawForeground();
+		void drawCoverage();
+		void buildCoverage();
 		void drawBirds();
+		void addSatellite(int,int,float,float);
+		void drawTracks();
+		void drawPastTracks();
+		void buildPastTracks();
+		int  pointsShown(GNSSSV *);
 		void drawInfo();
 		void drawSignalBars();
+		void drawSprites();
+		void logFrameStatistics();
 		
 		bool gridOn;
 		bool rotate;
 		bool animatedSky;
 		bool showForeground;
 		bool signalLevels;
+		bool tracksChanged; // an epoch has been committed since the tracks were last drawn
+		int  trackTime; // UNIX time the tracks are shown at, 0 for the latest
+		
+		TrackArchive *archive; // for the coverage underlay and past satellites, or NULL
+		int coverageSpan; // in seconds
+		QGLBuffer *coverageBuffer; // the lines of the underlay, or NULL if they're drawn from coverageLines
+		QVector<GLfloat> coverageLines; // x,y,r,g,b,a for each end of each line
+		int coverageVertices;
+		int coverageRevision,coverageTime; // of the archive, and the time shown, when the lines were built
+		float coverageAzMin,coverageAzMax;
+		
+		// satellites which have expired since the time the tracks are shown at, from the archive
+		QVector<GLfloat> pastLines; // x,y,r,g,b,a for each end of each line
+		QVector<int> pastSatellites; // constellation,PRN
+		QVector<GLfloat> pastPositions; // az,el at the time shown
+		int pastRevision,pastTime; // of the archive, and the time shown, when they were found
+		float pastAzMin,pastAzMax;
+		
+		bool vertexBuffers; // for the tracks, if shaders are available
+		QGLShaderProgram *trackProgram; // NULL if tracks are drawn in immediate mode
+		QHash<GNSSSV *,TrackBuffer *> trackBuffers;
+		
+		// CPU time spent drawing frames
+		QElapsedTimer frameClock;
+		int nFrames,frameNumber;
+		qint64 frameNsecs,frameNsecsMax,tracksNsecs;
+		qint64 lastFrameStats; // in ms
 		
 		double latitude,longitude;
 		
@@ -103,7 +155,6 @@ class GNSSViewWidget: public QGLWidget
 		double gammaCorrection_;
 		
 		QString receiver;
-		GLText *receiverLabel;
 		
 		SkyModel *skyModel;
 		QString foreground;
@@ -111,9 +162,8 @@ class GNSSViewWidget: public QGLWidget
 		QString nightSky;
 		QDateTime lastSkyUpdate;
 		int skyUpdateInterval;
-		bool smooth;
 		
-		Colour** skyColour;
+		QVector<GLfloat> skyRGB; // naz x (nel+1), by elevation then azimuth
 		int naz,nel;
 		
 		GLuint fgtex;
@@ -124,6 +174,7 @@ class GNSSViewWidget: public QGLWidget
 		int sunWidth,sunHeight;
 		GLuint nighttex;
 		int nightWidth,nightHeight;
+		GLuint skytex;
 		
 		double barWidth;
 		double sideMargin; // margin at the sides
@@ -131,10 +182,12 @@ class GNSSViewWidget: public QGLWidget
 		double constellationNameSpc; // 
 		double constellationMargin;
 	
-		QList<GNSSSV *> *birds;
+		SatelliteTable *birds;
 		QList<ConstellationProperties *> constellations;
 		
-		QList<GLText *> compassLabels;
+		SpriteBatch *sprites; // icons and text, drawn before the foreground and at the end of the frame
+		GlyphAtlas *text;
+		int labelFont;
 		
 		// debugging stuff
 		int tOffset; // in hours
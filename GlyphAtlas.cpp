@@ -0,0 +1,161 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+#include <QFontMetrics>
+#include <QGLWidget>
+#include <QImage>
+#include <QPainter>
+
+#include "GlyphAtlas.h"
+#include "SpriteBatch.h"
+
+GlyphAtlas::GlyphAtlas(QGLWidget *w,SpriteBatch *b)
+{
+	glx=w;
+	sprites=b;
+	shelfX=shelfY=shelfHeight=0;
+	
+	QVector<uchar> blank(ATLAS_SIZE*ATLAS_SIZE*4,0);
+	glGenTextures(1,&texture);
+	glBindTexture(GL_TEXTURE_2D,texture);
+	glTexEnvf(GL_TEXTURE_ENV,GL_TEXTURE_ENV_MODE,GL_REPLACE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, 0,
+      GL_RGBA, GL_UNSIGNED_BYTE, blank.constData());
+	glBindTexture(GL_TEXTURE_2D,0);
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	if (texture) {glDeleteTextures(1,&texture);}
+	qDeleteAll(fonts);
+}
+
+int GlyphAtlas::addFont(const QFont &f)
+{
+	QFontMetrics fm(f);
+	Font *font = new Font();
+	font->font=f;
+	font->ascent=fm.ascent();
+	font->descent=fm.descent();
+	font->height=fm.height();
+	fonts.append(font);
+	
+	for (ushort c=32;c<127;c++)
+		glyph(font,QChar(c));
+	
+	return fonts.size()-1;
+}
+
+int GlyphAtlas::width(int f,const QString &s)
+{
+	Font *font = fonts.at(f);
+	int w=0;
+	for (int i=0;i<s.size();i++){
+		const Glyph *g = glyph(font,s.at(i));
+		if (g) w += g->advance;
+	}
+	return w;
+}
+
+// Glyphs are laid out along the baseline, from the descent below it to the ascent above it.
+// Vertical text reads upwards.
+
+void GlyphAtlas::addText(int f,const QString &s,float x,float y,bool vertical)
+{
+	Font *font = fonts.at(f);
+	float v0 = -font->descent, v1 = font->ascent;
+	float u = 0.0;
+	for (int i=0;i<s.size();i++){
+		const Glyph *g = glyph(font,s.at(i));
+		if (!g) continue;
+		float u0 = u-ATLAS_PADDING, u1 = u+g->advance+ATLAS_PADDING;
+		GLfloat quad[16] = {u0,v0,g->s0,g->t0, u1,v0,g->s1,g->t0, u1,v1,g->s1,g->t1, u0,v1,g->s0,g->t1};
+		for (int k=0;k<16;k+=4){
+			GLfloat qu=quad[k],qv=quad[k+1];
+			quad[k]   = (vertical ? x-qv : x+qu);
+			quad[k+1] = (vertical ? y+qu : y+qv);
+		}
+		sprites->add(texture,quad);
+		u += g->advance;
+	}
+}
+
+//
+// Private
+//
+
+// Looks up a glyph, rasterising it into the atlas if it's new. NULL if there's no room left.
+
+const GlyphAtlas::Glyph *GlyphAtlas::glyph(Font *font,QChar c)
+{
+	QHash<ushort,Glyph>::const_iterator it = font->glyphs.constFind(c.unicode());
+	if (it != font->glyphs.constEnd())
+		return &(it.value());
+	
+	QFontMetrics fm(font->font);
+	int advance = fm.width(c);
+	int w = advance + 2*ATLAS_PADDING;
+	int h = font->height + 2*ATLAS_PADDING;
+	
+	if (shelfX + w > ATLAS_SIZE){ // next shelf up
+		shelfX=0;
+		shelfY+=shelfHeight;
+		shelfHeight=0;
+	}
+	if (shelfY + h > ATLAS_SIZE || w > ATLAS_SIZE){
+		qWarning() << "GlyphAtlas: no room for" << QString(c);
+		return NULL;
+	}
+	
+	QImage im(w,h,QImage::Format_ARGB32);
+	im.fill(0);
+	QPainter p;
+	p.begin(&im);
+	p.setPen(QColor(255,255,255,255));
+	p.setFont(font->font);
+	p.drawText(ATLAS_PADDING,ATLAS_PADDING+font->ascent,QString(c));
+	p.end();
+	QImage glim = glx->convertToGLFormat(im); // flipped, so the bottom row comes first
+	
+	glBindTexture(GL_TEXTURE_2D,texture);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, shelfX, shelfY, w, h, GL_RGBA, GL_UNSIGNED_BYTE, glim.bits());
+	glBindTexture(GL_TEXTURE_2D,0);
+	
+	// the cell, less the padding above and below, which is where the glyph quads go
+	Glyph g;
+	g.s0 = (float) shelfX/ATLAS_SIZE;
+	g.s1 = (float) (shelfX+w)/ATLAS_SIZE;
+	g.t0 = (float) (shelfY+ATLAS_PADDING)/ATLAS_SIZE;
+	g.t1 = (float) (shelfY+h-ATLAS_PADDING)/ATLAS_SIZE;
+	g.advance = advance;
+	
+	shelfX += w;
+	if (h > shelfHeight) shelfHeight=h;
+	
+	return &(font->glyphs.insert(c.unicode(),g).value());
+}
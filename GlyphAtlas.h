@@ -0,0 +1,89 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __GLYPH_ATLAS_H_
+#define __GLYPH_ATLAS_H_
+
+#include <GL/gl.h>
+
+#include <QFont>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QGLWidget;
+class SpriteBatch;
+
+#define ATLAS_SIZE 512 // pixels, square
+#define ATLAS_PADDING 1 // pixels around each glyph
+
+// Text drawn from glyphs rasterised into a single texture.
+// Printable ASCII is rasterised when a font is added, and anything else the first time it's used.
+// Text is queued, in window coordinates, as quads in a SpriteBatch.
+// Must be used, and deleted, with the GL context current.
+
+class GlyphAtlas
+{
+	public:
+	
+		GlyphAtlas(QGLWidget *,SpriteBatch *);
+		~GlyphAtlas();
+		
+		int addFont(const QFont &); // returns the font's index
+		
+		int width(int,const QString &);
+		int height(int font) const {return fonts.at(font)->height;}
+		int ascent(int font) const {return fonts.at(font)->ascent;}
+		int descent(int font) const {return fonts.at(font)->descent;}
+		
+		void addText(int,const QString &,float,float,bool vertical=false); // baseline starting at x,y
+		
+	private:
+	
+		class Glyph
+		{
+			public:
+				float s0,t0,s1,t1; // of the cell in the texture
+				int advance;
+		};
+		
+		class Font
+		{
+			public:
+				QFont font;
+				int ascent,descent,height;
+				QHash<ushort,Glyph> glyphs;
+		};
+		
+		const Glyph *glyph(Font *,QChar);
+		
+		QGLWidget *glx;
+		GLuint texture;
+		int shelfX,shelfY,shelfHeight; // where the next glyph goes
+		QList<Font *> fonts;
+		SpriteBatch *sprites;
+};
+
+#endif
@@ -0,0 +1,136 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+#include <QTimer>
+
+#include "DatagramDecoder.h"
+#include "DeviceSource.h"
+#include "FileTailSource.h"
+#include "Ingestor.h"
+#include "NMEADecoder.h"
+#include "ObservationRing.h"
+#include "SBFDecoder.h"
+#include "TcpSource.h"
+#include "UBXDecoder.h"
+#include "UdpSource.h"
+
+#define STATS_INTERVAL 600 // in seconds
+
+Ingestor::Ingestor(QList<ConstellationProperties *> &c,ObservationRing *r):constellations(c)
+{
+	ring=r;
+	statsTimer=NULL;
+}
+
+Ingestor::~Ingestor()
+{
+}
+
+void Ingestor::addInput(const InputSpec &spec)
+{
+	inputs.append(spec);
+}
+
+// The sources are created here, rather than in the constructor,
+// so that they belong to the ingest thread
+
+void Ingestor::start()
+{
+	for (int i=0;i<inputs.size();i++){
+		const InputSpec &spec = inputs.at(i);
+		StreamDecoder *decoder = createDecoder(spec.format);
+		if (!decoder){
+			qWarning() << "Unknown input format " << spec.format;
+			continue;
+		}
+		InputSource *source = createSource(spec,decoder); // which now owns the decoder
+		if (!source){
+			qWarning() << "Unknown input type " << spec.type;
+			delete decoder;
+			continue;
+		}
+		if (source->open())
+			sources.append(source);
+		else
+			delete source;
+	}
+	
+	if (sources.isEmpty())
+		qWarning() << "No inputs!";
+	
+	startStatistics();
+}
+
+//
+// Private slots
+//
+
+void Ingestor::logStatistics()
+{
+	for (int i=0;i<sources.size();i++)
+		sources.at(i)->logStatistics();
+	qInfo() << "observation ring: capacity=" << ring->capacity() << " occupancy=" << ring->occupancy() 
+		<< " high water=" << ring->highWater() << " pushed=" << ring->pushed() << " dropped=" << ring->dropped();
+}
+
+//
+// Private
+//
+
+StreamDecoder *Ingestor::createDecoder(QString format)
+{
+	if (format == "gnssview")
+		return new DatagramDecoder(constellations,ring);
+	else if (format == "sbf")
+		return new SBFDecoder(constellations,ring);
+	else if (format == "nmea")
+		return new NMEADecoder(constellations,ring);
+	else if (format == "ubx")
+		return new UBXDecoder(constellations,ring);
+	return NULL;
+}
+
+InputSource *Ingestor::createSource(const InputSpec &spec,StreamDecoder *decoder)
+{
+	if (spec.type == "udp")
+		return new UdpSource(spec.address,spec.port,spec.iface,spec.backend,decoder,this);
+	else if (spec.type == "tcp")
+		return new TcpSource(spec.address,spec.port,decoder,this);
+	else if (spec.type == "file")
+		return new FileTailSource(spec.path,spec.fromStart,decoder,this);
+	else if (spec.type == "serial")
+		return new DeviceSource(spec.path,spec.baud,decoder,this);
+	else if (spec.type == "stdin")
+		return new DeviceSource("-",0,decoder,this);
+	return NULL;
+}
+
+void Ingestor::startStatistics()
+{
+	statsTimer = new QTimer(this);
+	connect(statsTimer,SIGNAL(timeout()),this,SLOT(logStatistics()));
+	statsTimer->start(STATS_INTERVAL*1000);
+}
@@ -0,0 +1,79 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __INGESTOR_H_
+#define __INGESTOR_H_
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "InputSource.h"
+
+class QTimer;
+
+class ConstellationProperties;
+class ObservationRing;
+class StreamDecoder;
+
+// Reads and decodes receiver data from any number of inputs in its own thread,
+// passing the observations to the GUI thread via an ObservationRing.
+// Since all the inputs run in this one thread, the ring still has a single producer.
+// Create it, add the inputs, move it to its thread and then invoke start() in that thread.
+
+class Ingestor : public QObject
+{
+	Q_OBJECT
+	
+	public:
+	
+		Ingestor(QList<ConstellationProperties *> &,ObservationRing *);
+		~Ingestor();
+		
+		void addInput(const InputSpec &);
+		
+	public slots:
+	
+		void start();
+		
+	private slots:
+	
+		void logStatistics();
+		
+	private:
+	
+		StreamDecoder *createDecoder(QString);
+		InputSource *createSource(const InputSpec &,StreamDecoder *);
+		void startStatistics();
+		
+		QList<InputSpec> inputs;
+		QList<InputSource *> sources;
+		QTimer *statsTimer;
+		
+		QList<ConstellationProperties *> &constellations;
+		ObservationRing *ring;
+};
+
+#endif
@@ -0,0 +1,75 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+
+#include "InputSource.h"
+#include "StreamDecoder.h"
+
+InputSpec::InputSpec()
+{
+	format="gnssview";
+	port=-1;
+	backend="qt";
+	baud=0;
+	fromStart=false;
+}
+
+InputSource::InputSource(QString n,StreamDecoder *d,QObject *parent):QObject(parent)
+{
+	sourceName=n;
+	decoder=d;
+	nBytes=nReads=nErrors=nReconnects=0;
+}
+
+InputSource::~InputSource()
+{
+	delete decoder;
+}
+
+void InputSource::logStatistics()
+{
+	qInfo() << qPrintable(sourceName) << ": bytes=" << nBytes << " reads=" << nReads << " errors=" << nErrors 
+		<< " reconnects=" << nReconnects;
+	decoder->logStatistics();
+}
+
+//
+// Protected
+//
+
+void InputSource::received(const char *buf,int len)
+{
+	nReads++;
+	nBytes += len;
+	decoder->decode(buf,len);
+}
+
+void InputSource::receivedDatagram(const char *buf,int len)
+{
+	nReads++;
+	nBytes += len;
+	decoder->decodeDatagram(buf,len);
+}
@@ -0,0 +1,88 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __INPUT_SOURCE_H_
+#define __INPUT_SOURCE_H_
+
+#include <QObject>
+#include <QString>
+
+#define INPUT_READ_SIZE 4096
+
+class StreamDecoder;
+
+// Configuration of an input, as read from <inputs>.
+// Which fields are used depends on the type.
+
+class InputSpec
+{
+	public:
+	
+		InputSpec();
+		
+		QString type;       // udp, tcp, file, serial, stdin
+		QString format;     // the decoder: gnssview, sbf, nmea, ubx
+		QString address;    // multicast group or TCP host
+		int     port;
+		QString iface;      // for multicast, the interface by name or address
+		QString backend;    // for UDP, qt or recvmmsg
+		QString path;       // file or device
+		int     baud;       // 0 leaves the device's setting alone
+		bool    fromStart;  // for file, read what's already there
+};
+
+// Base class for sources of receiver data.
+// A source reads from its device in the ingest thread and passes
+// the data to its decoder, which it owns.
+
+class InputSource : public QObject
+{
+	Q_OBJECT
+	
+	public:
+	
+		InputSource(QString,StreamDecoder *,QObject *parent=0);
+		virtual ~InputSource();
+		
+		virtual bool open()=0;
+		virtual void logStatistics();
+		
+		QString name(){return sourceName;}
+		
+		unsigned long long nBytes;
+		unsigned long long nReads;      // reads or datagrams
+		unsigned long long nErrors;
+		unsigned long long nReconnects; // successful ones
+		
+	protected:
+	
+		void received(const char *,int);
+		void receivedDatagram(const char *,int);
+		
+		QString sourceName;
+		StreamDecoder *decoder;
+};
+
+#endif
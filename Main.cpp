@@ -49,7 +49,7 @@ void myMessageHandler(QtMsgType type, const QMessageLogContext &, const QString
         txt = QString("Fatal: %1").arg(msg);
     break;
     case QtInfoMsg:
-        txt = QString("Fatal: %1").arg(msg);
+        txt = QString("Info: %1").arg(msg);
     }
     QFile outFile("/tmp/gnssview.log");
     outFile.open(QIODevice::WriteOnly | QIODevice::Append);
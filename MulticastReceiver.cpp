@@ -0,0 +1,190 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include "MulticastReceiver.h"
+
+MulticastReceiver::MulticastReceiver(QObject *parent):QObject(parent)
+{
+	fd=-1;
+	notifier=NULL;
+	nreceived=0;
+	
+	// The buffers are allocated once and reused for every batch
+	buffers = new char[RECV_BATCH_SIZE*RECV_BUFFER_SIZE];
+	memset(msgs,0,sizeof(msgs));
+	for (int i=0;i<RECV_BATCH_SIZE;i++){
+		iovecs[i].iov_base = buffers + i*RECV_BUFFER_SIZE;
+		iovecs[i].iov_len  = RECV_BUFFER_SIZE;
+		msgs[i].msg_hdr.msg_iov = &(iovecs[i]);
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+	
+	nBatches=nDatagrams=nTruncated=0;
+	maxBatch=0;
+	for (int i=0;i<RECV_HIST_BINS;i++)
+		batchHist[i]=0;
+}
+
+MulticastReceiver::~MulticastReceiver()
+{
+	closeSocket();
+	delete[] buffers;
+}
+
+bool MulticastReceiver::open(QString address,int port,unsigned int ifaddr)
+{
+	closeSocket();
+	
+	fd = socket(AF_INET,SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,0);
+	if (fd < 0){
+		qWarning() << "MulticastReceiver: socket() failed: " << strerror(errno);
+		return false;
+	}
+	
+	int on=1; // same as QUdpSocket::ShareAddress
+	if (setsockopt(fd,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on)) < 0){
+		qDebug("Failed to set SO_REUSEADDR");
+	}
+	
+	sockaddr_in addr;
+	memset(&addr,0,sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if (bind(fd,(sockaddr *) &addr,sizeof(addr)) < 0){
+		qWarning() << "MulticastReceiver: bind() to port " << port << " failed: " << strerror(errno);
+		closeSocket();
+		return false;
+	}
+	
+	ip_mreq mreq;
+	memset(&mreq,0,sizeof(ip_mreq));
+	mreq.imr_multiaddr.s_addr = inet_addr(address.toStdString().c_str()); // group addr
+	mreq.imr_interface.s_addr = ifaddr; // network order, INADDR_ANY for the default
+	if (setsockopt(fd,IPPROTO_IP,IP_ADD_MEMBERSHIP,(const void *)&mreq,sizeof(mreq)) < 0){
+		qDebug("Failed to add to multicast group");
+	}
+	
+	unsigned int ttl = 38; // restricted to 38 hops
+	if (setsockopt(fd,IPPROTO_IP,IP_MULTICAST_TTL,(const char *)&ttl,sizeof(ttl)) < 0){
+		qDebug("Failed to set TTL");
+	}
+	
+	notifier = new QSocketNotifier(fd,QSocketNotifier::Read,this);
+	connect(notifier,SIGNAL(activated(int)),this,SIGNAL(readyRead()));
+	
+	return true;
+}
+
+// Reads a batch of datagrams, returning the number read.
+// The datagrams are valid until the next call.
+
+int MulticastReceiver::receive()
+{
+	nreceived=0;
+	if (fd < 0) return 0;
+	
+	for (int i=0;i<RECV_BATCH_SIZE;i++)
+		msgs[i].msg_hdr.msg_flags=0;
+		
+	int n = recvmmsg(fd,msgs,RECV_BATCH_SIZE,MSG_DONTWAIT,NULL);
+	if (n <= 0){
+		if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			qWarning() << "MulticastReceiver: recvmmsg() failed: " << strerror(errno);
+		return 0;
+	}
+	
+	nreceived=n;
+	
+	nBatches++;
+	nDatagrams += n;
+	if (n > maxBatch) maxBatch=n;
+	int bin=0;
+	while ((2 << bin) <= n && bin < RECV_HIST_BINS-1) bin++;
+	batchHist[bin]++;
+	
+	return n;
+}
+
+// Returns datagram i of the last batch, or NULL if it was truncated
+
+const char *MulticastReceiver::datagram(int i,int *len)
+{
+	*len=0;
+	if (i < 0 || i >= nreceived) return NULL;
+	if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC){
+		nTruncated++;
+		return NULL;
+	}
+	*len = msgs[i].msg_len;
+	return buffers + i*RECV_BUFFER_SIZE;
+}
+
+void MulticastReceiver::logStatistics()
+{
+	if (nBatches == 0) return;
+	QString hist;
+	for (int i=0;i<RECV_HIST_BINS;i++){
+		int lo = 1 << i;
+		int hi = (i==RECV_HIST_BINS-1 ? RECV_BATCH_SIZE : (2 << i) - 1);
+		if (lo == hi)
+			hist += QString(" %1:%2").arg(lo).arg(batchHist[i]);
+		else
+			hist += QString(" %1-%2:%3").arg(lo).arg(hi).arg(batchHist[i]);
+	}
+	qInfo() << "recvmmsg: batches=" << nBatches << " datagrams=" << nDatagrams 
+		<< " mean batch=" << (double) nDatagrams/nBatches << " max batch=" << maxBatch 
+		<< " truncated=" << nTruncated << " histogram:" << qPrintable(hist);
+}
+
+//
+// Private
+//
+
+void MulticastReceiver::closeSocket()
+{
+	if (notifier){
+		notifier->setEnabled(false);
+		delete notifier;
+		notifier=NULL;
+	}
+	if (fd >= 0){
+		::close(fd);
+		fd=-1;
+	}
+}
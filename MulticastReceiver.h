@@ -0,0 +1,82 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __MULTICAST_RECEIVER_H_
+#define __MULTICAST_RECEIVER_H_
+
+#include <QObject>
+#include <QString>
+
+#include <sys/socket.h>
+
+#define RECV_BATCH_SIZE  64     // maximum number of datagrams read per system call
+#define RECV_BUFFER_SIZE 16384  // larger datagrams are truncated and dropped
+#define RECV_HIST_BINS   7      // batch size histogram bins: 1,2-3,4-7,...,32-63,64
+
+class QSocketNotifier;
+
+// Linux-only multicast receiver which drains the socket with recvmmsg(),
+// so that a burst of datagrams costs one system call rather than one per datagram.
+// Used like QUdpSocket: on readyRead(), call receive() until it returns 0.
+
+class MulticastReceiver : public QObject
+{
+	Q_OBJECT
+	
+	public:
+	
+		MulticastReceiver(QObject *parent=0);
+		~MulticastReceiver();
+		
+		bool open(QString,int,unsigned int);
+		
+		int  receive();
+		const char *datagram(int,int *);
+		
+		void logStatistics();
+		
+	signals:
+	
+		void readyRead();
+		
+	private:
+	
+		void closeSocket();
+		
+		int fd;
+		QSocketNotifier *notifier;
+		
+		char   *buffers; // one contiguous allocation, RECV_BATCH_SIZE*RECV_BUFFER_SIZE
+		mmsghdr msgs[RECV_BATCH_SIZE];
+		iovec   iovecs[RECV_BATCH_SIZE];
+		int     nreceived;
+		
+		// statistics
+		unsigned long long nBatches,nDatagrams,nTruncated;
+		int maxBatch;
+		unsigned long long batchHist[RECV_HIST_BINS];
+};
+
+#endif
@@ -0,0 +1,289 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <string.h>
+#include <time.h>
+
+#include <QDebug>
+
+#include "GNSSSV.h"
+#include "NMEADecoder.h"
+
+// Parses a field as a non-negative integer. An empty or malformed field gives -1
+static int toInt(const char *p,int len)
+{
+	if (len <= 0) return -1;
+	int v=0;
+	for (int i=0;i<len;i++){
+		if (p[i] < '0' || p[i] > '9') return -1;
+		v = v*10 + (p[i]-'0');
+	}
+	return v;
+}
+
+static int hexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c-'0';
+	if (c >= 'A' && c <= 'F') return c-'A'+10;
+	if (c >= 'a' && c <= 'f') return c-'a'+10;
+	return -1;
+}
+
+NMEADecoder::NMEADecoder(QList<ConstellationProperties *> &c,ObservationRing *r):StreamDecoder(c,r)
+{
+	for (int t=0;t<NTalkers;t++){
+		groups[t].total=groups[t].next=0;
+		groups[t].signalID=-1;
+		groups[t].nobs=0;
+	}
+	nFields=0;
+}
+
+void NMEADecoder::decode(const char *buf,int len)
+{
+	// Complete sentences are decoded where they lie. Only a trailing partial sentence is kept.
+	if (pending.isEmpty()){
+		int used = scan(buf,len);
+		if (used < len)
+			pending.append(buf+used,len-used);
+	}
+	else{
+		pending.append(buf,len);
+		int used = scan(pending.constData(),pending.size());
+		pending.remove(0,used);
+	}
+}
+
+// Returns the index of the two letter talker ID, or -1 if it's not one we use
+
+int NMEADecoder::talker(const char *id)
+{
+	switch (id[0]){
+		case 'G':
+			switch (id[1]){
+				case 'P': return GP;
+				case 'L': return GL;
+				case 'A': return GA;
+				case 'B': return GB;
+				case 'Q': return GQ;
+				case 'N': return GN;
+			}
+			break;
+		case 'B': if (id[1] == 'D') return GB; break; // older Beidou receivers
+		case 'Q': if (id[1] == 'Z') return GQ; break;
+	}
+	return -1;
+}
+
+// Maps a GSV satellite ID to constellation and PRN.
+// GP and GN use the NMEA numbering (SBAS 33-64, GLONASS 65-96) plus the common 
+// extensions for QZSS (193-), Beidou (201-) and Galileo (301-).
+
+bool NMEADecoder::NMEAtoGNSSParams(int t,int id,int *constellation,int *prn)
+{
+	*constellation=-1;
+	*prn=-1;
+	
+	switch (t){
+		case GP: case GN:
+			if (id >= 1 && id <= 32){
+				*constellation=GNSSSV::GPS;
+				*prn=id;
+			}
+			else if (id >= 33 && id <= 64){ // PRN 120-151
+				*constellation=GNSSSV::SBAS;
+				*prn=id+87-100;
+			}
+			else if (id >= 65 && id <= 96){
+				*constellation=GNSSSV::GLONASS;
+				*prn=id-64;
+			}
+			else if (id >= 193 && id <= 199){
+				*constellation=GNSSSV::QZSS;
+				*prn=id-192;
+			}
+			else if (id >= 201 && id <= 263){
+				*constellation=GNSSSV::Beidou;
+				*prn=id-200;
+			}
+			else if (id >= 301 && id <= 336){
+				*constellation=GNSSSV::Galileo;
+				*prn=id-300;
+			}
+			break;
+		case GL:
+			*constellation=GNSSSV::GLONASS;
+			*prn=(id >= 65 ? id-64 : id);
+			break;
+		case GA:
+			*constellation=GNSSSV::Galileo;
+			*prn=(id >= 301 ? id-300 : id);
+			break;
+		case GB:
+			*constellation=GNSSSV::Beidou;
+			*prn=(id >= 401 ? id-400 : (id >= 201 ? id-200 : id));
+			break;
+		case GQ:
+			*constellation=GNSSSV::QZSS;
+			*prn=(id >= 193 ? id-192 : id);
+			break;
+	}
+	
+	return (*constellation != -1);
+}
+
+//
+// Private
+//
+
+// Decodes all complete sentences in the buffer. Returns the number of bytes used
+int NMEADecoder::scan(const char *buf,int len)
+{
+	int i=0;
+	while (i < len){
+		if (buf[i] != '$'){
+			i++;
+			nSkipped++;
+			continue;
+		}
+		int n = len-i;
+		const char *eol = (const char *) memchr(buf+i,'\n',(n > NMEA_MAX_LENGTH ? NMEA_MAX_LENGTH : n));
+		if (!eol){
+			if (n < NMEA_MAX_LENGTH) break; // wait for the rest of it
+			i++; // too long, so it's garbage
+			nSkipped++;
+			continue;
+		}
+		decodeSentence(buf+i,eol-(buf+i));
+		i = eol-buf+1;
+	}
+	return i;
+}
+
+void NMEADecoder::decodeSentence(const char *s,int len)
+{
+	if (len > 0 && s[len-1] == '\r') len--;
+	
+	// $<address>,<field>,...*<checksum>
+	if (len < 4 || s[len-3] != '*'){
+		nBadMessages++;
+		return;
+	}
+	int hi = hexDigit(s[len-2]);
+	int lo = hexDigit(s[len-1]);
+	unsigned char sum=0;
+	for (int i=1;i<len-3;i++)
+		sum ^= (unsigned char) s[i];
+	if (hi < 0 || lo < 0 || sum != ((hi << 4) | lo)){
+		nBadMessages++;
+		return;
+	}
+	nMessages++;
+	
+	// Tokenize, without copying
+	const char *p = s+1;
+	const char *end = s+len-3;
+	nFields=0;
+	while (nFields < NMEA_MAX_FIELDS){
+		const char *comma = (const char *) memchr(p,',',end-p);
+		const char *fend = (comma ? comma : end);
+		field[nFields]=p;
+		fieldLength[nFields]=fend-p;
+		nFields++;
+		if (!comma) break;
+		p = comma+1;
+	}
+	
+	// Only GSV is used. GSA (the satellites used in the fix) has nothing we display
+	if (fieldLength[0] != 5 || strncmp(field[0]+2,"GSV",3)) return;
+	int t = talker(field[0]);
+	if (t >= 0)
+		decodeGSV(t);
+}
+
+void NMEADecoder::decodeGSV(int t)
+{
+	// GSV,<number of sentences>,<sentence number>,<satellites in view>,{<ID>,<elevation>,<azimuth>,<SNR>}[,<signal ID>]
+	if (nFields < 4){
+		nBadMessages++;
+		return;
+	}
+	int total = toInt(field[1],fieldLength[1]);
+	int num   = toInt(field[2],fieldLength[2]);
+	if (total < 1 || num < 1 || num > total){
+		nBadMessages++;
+		return;
+	}
+	
+	GSVGroup &g = groups[t];
+	
+	int nsv = (nFields-4)/4;
+	if ((nFields-4) % 4 == 1){ // NMEA 4.10
+		int signalID = toInt(field[nFields-1],fieldLength[nFields-1]);
+		if (g.signalID == -1)
+			g.signalID = signalID;
+		else if (signalID != g.signalID)
+			return;
+	}
+	
+	if (num == 1){
+		g.total=total;
+		g.nobs=0;
+	}
+	else if (num != g.next || total != g.total){ // missed a sentence so drop the group
+		g.next=0;
+		return;
+	}
+	g.next = num+1;
+	
+	for (int s=0;s<nsv;s++){
+		int f = 4+4*s;
+		int id   = toInt(field[f],fieldLength[f]);
+		int elev = toInt(field[f+1],fieldLength[f+1]);
+		int az   = toInt(field[f+2],fieldLength[f+2]);
+		int snr  = toInt(field[f+3],fieldLength[f+3]); // empty if not tracked
+		if (id < 0 || elev < 0 || az < 0) continue;
+		int constellation,prn;
+		if (!NMEAtoGNSSParams(t,id,&constellation,&prn)) continue;
+		if (!validate(constellation,prn)) continue;
+		if (g.nobs == NMEA_MAX_GROUP_OBS) break;
+		Observation &o = g.obs[g.nobs++];
+		o.constellation=constellation;
+		o.PRN=prn;
+		o.az=az;
+		o.elev=elev;
+		o.sn=(snr < 0 ? 0 : snr);
+	}
+	
+	if (num == total){
+		int tnow = time(NULL); // as for SBF
+		for (int i=0;i<g.nobs;i++)
+			g.obs[i].timestamp=tnow;
+		if (g.nobs > 0)
+			publish(g.obs,g.nobs);
+		g.next=0;
+		g.nobs=0;
+	}
+}
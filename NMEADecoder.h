@@ -0,0 +1,83 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __NMEA_DECODER_H_
+#define __NMEA_DECODER_H_
+
+#include <QByteArray>
+
+#include "Observation.h"
+#include "StreamDecoder.h"
+
+#define NMEA_MAX_LENGTH    128 // the standard says 82 but some receivers exceed it
+#define NMEA_MAX_FIELDS    32
+#define NMEA_MAX_GROUP_OBS 64
+
+// Decodes NMEA 0183 GSV sentences.
+// Sentences in a GSV group are collected and the group is published as one 
+// epoch when its last sentence arrives. A group with a missing or out of 
+// sequence sentence is discarded.
+// Where a receiver reports several signals per satellite (NMEA 4.10 signal ID),
+// only the first signal seen for each talker is used.
+
+class NMEADecoder : public StreamDecoder
+{
+	public:
+	
+		enum Talker {GP=0,GL=1,GA=2,GB=3,GQ=4,GN=5,NTalkers=6};
+		
+		NMEADecoder(QList<ConstellationProperties *> &,ObservationRing *);
+		
+		virtual void decode(const char *,int);
+		virtual QString name(){return "NMEA";}
+		
+		static int talker(const char *);
+		static bool NMEAtoGNSSParams(int,int,int *,int *);
+		
+	private:
+	
+		class GSVGroup
+		{
+			public:
+				int total,next;
+				int signalID;
+				int nobs;
+				Observation obs[NMEA_MAX_GROUP_OBS];
+		};
+		
+		int  scan(const char *,int);
+		void decodeSentence(const char *,int);
+		void decodeGSV(int);
+		
+		QByteArray pending;
+		GSVGroup groups[NTalkers];
+		
+		// the current sentence, as pointers into the input
+		const char *field[NMEA_MAX_FIELDS];
+		int fieldLength[NMEA_MAX_FIELDS];
+		int nFields;
+};
+
+#endif
@@ -23,32 +23,23 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#ifndef __OBSERVATION_H_
+#define __OBSERVATION_H_
 
-#ifndef __GL_TEXT_H_
-#define __GL_TEXT_H_
+#define MAX_OBSERVATIONS 256 // size of the working arrays of observations
 
-#include <GL/gl.h>
+// A single satellite observation, as decoded from the wire.
+// Fixed size so that it can be passed around in preallocated arrays
 
-#include <QColor>
-#include <QFont>
-#include <QString>
-
-class QColor;
-class QGLWidget;
-
-class GLText
+class Observation
 {
 	public:
-
-		GLText(QGLWidget *,QString,QFont,QColor color= QColor(255,255,255,255));
-		~GLText();
-
-		void paint();
-		
-		GLuint texture;
-		int w,h;
-		int ascent;
-		int descent;
+	
+		int    timestamp; // UNIX time
+		int    constellation;
+		int    PRN;
+		double az,elev;
+		double sn; // as reported by the receiver ie not scaled
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ObservationRing.h"
+
+ObservationRing::ObservationRing(int minSize)
+{
+	size=1;
+	while (size < minSize) size <<= 1;
+	mask = size-1;
+	buf = new Observation[size];
+	
+	head.store(0);
+	tail.store(0);
+	maxOccupancy.store(0);
+	nDropped.store(0);
+	nPushed.store(0);
+}
+
+ObservationRing::~ObservationRing()
+{
+	delete[] buf;
+}
+
+// The indices run freely and wrap around at 2^32: only their difference matters
+
+bool ObservationRing::push(const Observation *obs,int n)
+{
+	unsigned int t = tail.load(); // only we write this
+	unsigned int h = head.loadAcquire();
+	unsigned int used = t-h;
+	
+	if (used + n > (unsigned int) size){
+		nDropped.fetchAndAddRelaxed(n);
+		return false;
+	}
+	
+	for (int i=0;i<n;i++)
+		buf[(t+i) & mask] = obs[i];
+	tail.storeRelease(t+n); // publishes them all at once
+	
+	nPushed.fetchAndAddRelaxed(n);
+	if ((int) (used + n) > maxOccupancy.load())
+		maxOccupancy.store(used+n);
+	return true;
+}
+
+int ObservationRing::pop(Observation *obs,int max)
+{
+	unsigned int h = head.load(); // only we write this
+	unsigned int t = tail.loadAcquire();
+	int n = t-h;
+	if (n > max) n = max;
+	
+	for (int i=0;i<n;i++)
+		obs[i] = buf[(h+i) & mask];
+	head.storeRelease(h+n);
+	
+	return n;
+}
+
+int ObservationRing::occupancy()
+{
+	unsigned int t = tail.loadAcquire();
+	unsigned int h = head.loadAcquire();
+	return t-h;
+}
@@ -0,0 +1,65 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __OBSERVATION_RING_H_
+#define __OBSERVATION_RING_H_
+
+#include <QAtomicInt>
+
+#include "Observation.h"
+
+// Bounded, lock-free ring for handing observations from the ingest thread (the single producer)
+// to the GUI thread (the single consumer).
+// A push is all or nothing, so observations pushed together are seen together.
+
+class ObservationRing
+{
+	public:
+	
+		ObservationRing(int);
+		~ObservationRing();
+		
+		bool push(const Observation *,int);  // producer
+		int  pop(Observation *,int);         // consumer
+		
+		int capacity(){return size;}
+		int occupancy();
+		int highWater(){return maxOccupancy.load();}
+		int dropped(){return nDropped.load();}
+		int pushed(){return nPushed.load();}
+		
+	private:
+	
+		Observation *buf;
+		int size; // a power of 2
+		int mask;
+		
+		QAtomicInt head; // next slot to read, written by the consumer
+		QAtomicInt tail; // next slot to write, written by the producer
+		
+		QAtomicInt maxOccupancy,nDropped,nPushed;
+};
+
+#endif
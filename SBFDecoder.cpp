@@ -0,0 +1,275 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <time.h>
+
+#include <QDebug>
+
+#include "GNSSSV.h"
+#include "SBFDecoder.h"
+
+#define SBF_HEADER_SIZE     8
+#define SBF_MEAS_EPOCH      4027
+#define SBF_SAT_VISIBILITY  4012
+
+static unsigned int crcTable[256];
+static bool crcTableInit=false;
+
+static inline unsigned int getU16(const char *p)
+{
+	return (unsigned char) p[0] | ((unsigned char) p[1] << 8);
+}
+
+static inline int getS16(const char *p)
+{
+	return (short) getU16(p);
+}
+
+SBFDecoder::SBFDecoder(QList<ConstellationProperties *> &c,ObservationRing *r):StreamDecoder(c,r)
+{
+	if (!crcTableInit){ // CRC-CCITT, polynomial 0x1021
+		for (int i=0;i<256;i++){
+			unsigned int crc = i << 8;
+			for (int b=0;b<8;b++)
+				crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+			crcTable[i] = crc & 0xffff;
+		}
+		crcTableInit=true;
+	}
+	clearEpoch();
+}
+
+void SBFDecoder::decode(const char *buf,int len)
+{
+	pending.append(buf,len);
+	
+	const char *p = pending.constData();
+	int n = pending.size();
+	int i=0;
+	
+	while (n-i >= SBF_HEADER_SIZE){
+		// Header is sync (2) | CRC (2) | ID (2) | length (2)
+		if (!(p[i] == '$' && p[i+1] == '@')){
+			i++;
+			nSkipped++;
+			continue;
+		}
+		int length = getU16(p+i+6); // includes the header
+		if (length < SBF_HEADER_SIZE || (length & 0x03)){ // not a valid header so resync
+			i++;
+			nSkipped++;
+			continue;
+		}
+		if (n-i < length) break; // wait for the rest of it
+		
+		if (crc16(p+i+4,length-4) != getU16(p+i+2)){
+			i++; // might have been a spurious sync so resync from the next byte
+			nBadMessages++;
+			continue;
+		}
+		
+		nMessages++;
+		decodeBlock(p+i,length);
+		i += length;
+	}
+	
+	pending.remove(0,i);
+}
+
+// The CRC is computed over the ID, length and body of the block
+
+unsigned int SBFDecoder::crc16(const char *buf,int len)
+{
+	unsigned int crc=0;
+	for (int i=0;i<len;i++)
+		crc = ((crc << 8) ^ crcTable[((crc >> 8) ^ (unsigned char) buf[i]) & 0xff]) & 0xffff;
+	return crc;
+}
+
+// Maps an SBF SVID to constellation, PRN and the signal type whose C/N0 is used
+
+bool SBFDecoder::SVIDtoGNSSParams(int svid,int *constellation,int *prn,int *reqsig)
+{
+	*reqsig=-1;
+	*constellation=-1;
+	*prn=-1;
+	
+	if (svid <= 37){ // GPS
+		*reqsig=0;
+		*constellation=GNSSSV::GPS;
+		*prn=svid;
+	}
+	else if (svid >= 181 && svid <= 187){ // QZSS
+		*reqsig=6;
+		*constellation=GNSSSV::QZSS;
+		*prn=svid-180;
+	}
+	else if (svid >= 38 && svid <= 62){ // GLONASS
+		*reqsig=8;
+		*constellation=GNSSSV::GLONASS;
+		*prn=svid-37;
+	}
+	else if (svid >= 71 && svid <= 102){ // Galileo
+		*reqsig=17;
+		*constellation=GNSSSV::Galileo;
+		*prn=svid-70;
+	}
+	else if (svid >= 120 && svid <= 140){ // SBAS
+		*reqsig=24;
+		*constellation=GNSSSV::SBAS;
+		*prn=svid-100;
+	}
+	else if (svid >= 141 && svid <= 172){ // Beidou
+		*reqsig=28;
+		*constellation=GNSSSV::Beidou;
+		*prn=svid-140;
+	}
+	
+	return (*constellation != -1);
+}
+
+//
+// Private
+//
+
+void SBFDecoder::decodeBlock(const char *block,int length)
+{
+	int id = getU16(block+4) & 0x1fff; // the rest is the block revision
+	const char *body = block + SBF_HEADER_SIZE;
+	int bodyLength = length - SBF_HEADER_SIZE;
+	
+	if (id == SBF_MEAS_EPOCH){
+		decodeMeasEpoch(body,bodyLength);
+		gotMeasEpoch=true;
+	}
+	else if (id == SBF_SAT_VISIBILITY){
+		decodeSatVisibility(body,bodyLength);
+		gotSatVisibility=true;
+	}
+	
+	if (gotMeasEpoch && gotSatVisibility)
+		publishEpoch();
+}
+
+void SBFDecoder::decodeMeasEpoch(const char *d,int len)
+{
+	// TOW (4) | WNc (2) | N1 (1) | SB1Length (1) | SB2Length (1) | CommonFlags (1) | CumClkJumps (1) | Reserved (1)
+	if (len < 12) return;
+	int N1 = (unsigned char) d[6];
+	int SB1Length = (unsigned char) d[7];
+	int SB2Length = (unsigned char) d[8];
+	if (SB1Length < 20 || SB2Length < 3) return;
+	
+	int offset=12;
+	for (int n=0;n<N1;n++){
+		if (offset + SB1Length > len) return;
+		// Type1 sub-block:
+		// RxChannel (1) | Type (1) | SVID (1) | Misc (1) | CodeLSB (4) | Doppler (4) | CarrierLSB (2) | CarrierMSB (1) | 
+		// CN0 (1) | LockTime (2) | ObsInfo (1) | N2 (1)
+		const char *b1 = d + offset;
+		int sig = (unsigned char) b1[1] & 31;
+		int svid = (unsigned char) b1[2];
+		int cn = (unsigned char) b1[15];
+		int N2 = (unsigned char) b1[19];
+		offset += SB1Length;
+		
+		int constellation,prn,reqsig;
+		if (SVIDtoGNSSParams(svid,&constellation,&prn,&reqsig)){
+			if (constellation == GNSSSV::SBAS)
+				reqsig = sig; // KLUDGE
+			if (sig == reqsig){
+				sv[svid].cn = cn;
+				sv[svid].gotCN=true;
+			}
+			else{ // search the Type2 sub-blocks
+				// Type (1) | LockTime (1) | CN0 (1) | ...
+				for (int m=0;m<N2 && offset + (m+1)*SB2Length <= len;m++){
+					const char *b2 = d + offset + m*SB2Length;
+					if (((unsigned char) b2[0] & 31) == reqsig){
+						sv[svid].cn = (unsigned char) b2[2];
+						sv[svid].gotCN=true;
+						break;
+					}
+				}
+			}
+		}
+		offset += N2*SB2Length;
+	}
+}
+
+void SBFDecoder::decodeSatVisibility(const char *d,int len)
+{
+	// TOW (4) | WNc (2) | N (1) | SBLength (1)
+	if (len < 8) return;
+	int N = (unsigned char) d[6];
+	int SBLength = (unsigned char) d[7];
+	if (SBLength < 6) return;
+	
+	for (int m=0;m<N;m++){
+		int offset = 8 + m*SBLength;
+		if (offset + SBLength > len) return;
+		// SVID (1) | FreqNr (1) | Azimuth (2) | Elevation (2) | ...
+		const char *b = d + offset;
+		int svid = (unsigned char) b[0];
+		unsigned int az = getU16(b+2);
+		int el = getS16(b+4);
+		if (az == 65535 || el == -32768) continue; // do-not-use values
+		
+		int constellation,prn,reqsig;
+		if (!SVIDtoGNSSParams(svid,&constellation,&prn,&reqsig)) continue;
+		sv[svid].az = az/100.0;
+		sv[svid].elev = el/100.0;
+		sv[svid].gotPosition=true;
+	}
+}
+
+void SBFDecoder::publishEpoch()
+{
+	int t = time(NULL); // as sbfsim.pl does, so that replayed data is current
+	int nobs=0;
+	for (int svid=0;svid<SBF_MAX_SVID;svid++){
+		if (!(sv[svid].gotPosition && sv[svid].gotCN)) continue;
+		int constellation,prn,reqsig;
+		SVIDtoGNSSParams(svid,&constellation,&prn,&reqsig);
+		if (!validate(constellation,prn)) continue;
+		Observation &o = epoch[nobs++];
+		o.timestamp=t;
+		o.constellation=constellation;
+		o.PRN=prn;
+		o.az=sv[svid].az;
+		o.elev=sv[svid].elev;
+		o.sn=sv[svid].cn;
+	}
+	if (nobs > 0)
+		publish(epoch,nobs);
+	clearEpoch();
+}
+
+void SBFDecoder::clearEpoch()
+{
+	for (int svid=0;svid<SBF_MAX_SVID;svid++)
+		sv[svid].gotPosition = sv[svid].gotCN = false;
+	gotMeasEpoch=gotSatVisibility=false;
+}
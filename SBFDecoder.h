@@ -0,0 +1,74 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __SBF_DECODER_H_
+#define __SBF_DECODER_H_
+
+#include <QByteArray>
+
+#include "Observation.h"
+#include "StreamDecoder.h"
+
+#define SBF_MAX_SVID 256
+
+// Decodes Septentrio Binary Format (SBF).
+// Azimuth and elevation come from SatVisibility (4012) blocks and
+// signal levels from MeasEpoch (4027) blocks. An epoch is published
+// once both have been seen, as sbfsim.pl does.
+
+class SBFDecoder : public StreamDecoder
+{
+	public:
+	
+		SBFDecoder(QList<ConstellationProperties *> &,ObservationRing *);
+		
+		virtual void decode(const char *,int);
+		virtual QString name(){return "SBF";}
+		
+		static unsigned int crc16(const char *,int);
+		static bool SVIDtoGNSSParams(int,int *,int *,int *);
+		
+	private:
+	
+		class SVState
+		{
+			public:
+				bool   gotPosition,gotCN;
+				double az,elev,cn;
+		};
+		
+		void decodeBlock(const char *,int);
+		void decodeMeasEpoch(const char *,int);
+		void decodeSatVisibility(const char *,int);
+		void publishEpoch();
+		void clearEpoch();
+		
+		QByteArray pending;
+		bool gotMeasEpoch,gotSatVisibility;
+		SVState sv[SBF_MAX_SVID];
+		Observation epoch[SBF_MAX_SVID];
+};
+
+#endif
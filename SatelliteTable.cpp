@@ -0,0 +1,102 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+
+#include "ConstellationProperties.h"
+#include "SatelliteTable.h"
+
+SatelliteTable::SatelliteTable(QList<ConstellationProperties *> &constellations)
+{
+	int nslots=0;
+	for (int c=GNSSSV::Beidou;c<=GNSSSV::SBAS;c++){
+		ConstellationProperties *cprop = constellations.at(c);
+		svIDmin[c]=cprop->svIDmin;
+		svIDmax[c]=cprop->svIDmax;
+		offset[c]=nslots;
+		nslots += svIDmax[c]-svIDmin[c]+1;
+	}
+	table.fill(NULL,nslots);
+}
+
+SatelliteTable::~SatelliteTable()
+{
+	qDeleteAll(all);
+}
+
+GNSSSV *SatelliteTable::find(int c,int prn)
+{
+	int s = slot(c,prn);
+	if (s < 0) return NULL;
+	return table.at(s);
+}
+
+bool SatelliteTable::insert(GNSSSV *sv)
+{
+	int s = slot(sv->constellation,sv->PRN);
+	if (s < 0 || table.at(s) != NULL){
+		qWarning() << "SatelliteTable: can't insert " << sv->constellation << ":" << sv->PRN;
+		return false;
+	}
+	table[s]=sv;
+	sv->allIndex=all.size();
+	all.append(sv);
+	QList<GNSSSV *> &members = constellationMembers[sv->constellation];
+	sv->memberIndex=members.size();
+	members.append(sv);
+	return true;
+}
+
+void SatelliteTable::remove(GNSSSV *sv)
+{
+	int s = slot(sv->constellation,sv->PRN);
+	if (s < 0 || table.at(s) != sv) return;
+	table[s]=NULL;
+	
+	// swap with the last, and remove that
+	GNSSSV *last = all.last();
+	all[sv->allIndex]=last;
+	last->allIndex=sv->allIndex;
+	all.removeLast();
+	
+	QList<GNSSSV *> &members = constellationMembers[sv->constellation];
+	last = members.last();
+	members[sv->memberIndex]=last;
+	last->memberIndex=sv->memberIndex;
+	members.removeLast();
+	
+	delete sv;
+}
+
+//
+// Private
+//
+
+int SatelliteTable::slot(int c,int prn)
+{
+	if (c < GNSSSV::Beidou || c > GNSSSV::SBAS) return -1;
+	if (prn < svIDmin[c] || prn > svIDmax[c]) return -1;
+	return offset[c] + prn - svIDmin[c];
+}
@@ -0,0 +1,69 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __SATELLITE_TABLE_H_
+#define __SATELLITE_TABLE_H_
+
+#include <QList>
+#include <QVector>
+
+#include "GNSSSV.h"
+
+class ConstellationProperties;
+
+// Satellites, directly indexed by (constellation,PRN).
+// The table is laid out from the svIDmin/svIDmax range of each constellation.
+// Also keeps the list of satellites in each constellation. The lists are unordered: a satellite
+// which is removed is replaced by the last in the list, so removal costs the same whatever the fleet size.
+// For PRN order, step through the PRNs with find().
+
+class SatelliteTable
+{
+	public:
+	
+		SatelliteTable(QList<ConstellationProperties *> &);
+		~SatelliteTable();
+		
+		GNSSSV *find(int,int);
+		bool    insert(GNSSSV *); // takes ownership
+		void    remove(GNSSSV *); // and deletes it
+		
+		int     size(){return all.size();}
+		GNSSSV *at(int i){return all.at(i);}
+		const QList<GNSSSV *> & members(int c){return constellationMembers[c];}
+		
+	private:
+	
+		int slot(int,int);
+		
+		QVector<GNSSSV *> table;
+		int offset[GNSSSV::SBAS+1];
+		int svIDmin[GNSSSV::SBAS+1],svIDmax[GNSSSV::SBAS+1];
+		
+		QList<GNSSSV *> all;
+		QList<GNSSSV *> constellationMembers[GNSSSV::SBAS+1];
+};
+
+#endif
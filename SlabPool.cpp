@@ -0,0 +1,85 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+
+#include <QtGlobal>
+
+#include "SlabPool.h"
+
+SlabPool::SlabPool(size_t s)
+{
+	size_t align = sizeof(double) > sizeof(void *) ? sizeof(double) : sizeof(void *);
+	if (s < sizeof(FreeBlock)) s = sizeof(FreeBlock);
+	size = ((s + align - 1)/align)*align;
+	blocksPerSlab = qMax((int) (SLAB_SIZE/size),1);
+	freeList=NULL;
+	nBlocks=nInUse=maxInUse=0;
+}
+
+SlabPool::~SlabPool()
+{
+	for (int i=0;i<slabList.size();i++)
+		free(slabList.at(i));
+}
+
+void *SlabPool::allocate()
+{
+	if (!freeList)
+		grow();
+	FreeBlock *b = freeList;
+	freeList = b->next;
+	nInUse++;
+	if (nInUse > maxInUse)
+		maxInUse = nInUse;
+	return b;
+}
+
+void SlabPool::release(void *p)
+{
+	if (!p) return;
+	FreeBlock *b = (FreeBlock *) p;
+	b->next = freeList;
+	freeList = b;
+	nInUse--;
+}
+
+//
+// Private
+//
+
+void SlabPool::grow()
+{
+	char *slab = (char *) malloc(blocksPerSlab*size);
+	if (!slab)
+		qFatal("SlabPool: out of memory");
+	slabList.append(slab);
+	for (int i=blocksPerSlab-1;i>=0;i--){ // so that the first block is used first
+		FreeBlock *b = (FreeBlock *) (slab + i*size);
+		b->next = freeList;
+		freeList = b;
+	}
+	nBlocks += blocksPerSlab;
+}
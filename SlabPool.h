@@ -0,0 +1,69 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __SLAB_POOL_H_
+#define __SLAB_POOL_H_
+
+#include <stddef.h>
+
+#include <QList>
+
+#define SLAB_SIZE 65536 // bytes, but a slab holds at least one block
+
+// Fixed-size blocks, carved out of slabs which are kept until the pool is destroyed.
+// Released blocks go on a free list and are handed out again, so objects which come and go 
+// all day recycle the same memory rather than fragmenting the heap.
+
+class SlabPool
+{
+	public:
+	
+		SlabPool(size_t);
+		~SlabPool();
+		
+		void *allocate();
+		void  release(void *);
+		
+		size_t blockSize(){return size;}
+		int capacity(){return nBlocks;}     // blocks in all slabs
+		int inUse(){return nInUse;}
+		int highWater(){return maxInUse;}
+		int available(){return nBlocks - nInUse;}
+		int slabs(){return slabList.size();}
+		
+	private:
+	
+		void grow();
+		
+		struct FreeBlock {FreeBlock *next;};
+		
+		size_t size;
+		int blocksPerSlab;
+		FreeBlock *freeList;
+		QList<char *> slabList;
+		int nBlocks,nInUse,maxInUse;
+};
+
+#endif
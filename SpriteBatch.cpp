@@ -0,0 +1,95 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "SpriteBatch.h"
+
+SpriteBatch::SpriteBatch()
+{
+	nLayers=0;
+	nQuads=0;
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	qDeleteAll(layers);
+}
+
+void SpriteBatch::add(GLuint texture,float x0,float y0,float x1,float y1,float s0,float t0,float s1,float t1)
+{
+	GLfloat quad[16] = {x0,y0,s0,t0, x1,y0,s1,t0, x1,y1,s1,t1, x0,y1,s0,t1};
+	add(texture,quad);
+}
+
+void SpriteBatch::add(GLuint texture,const GLfloat *quad)
+{
+	QVector<GLfloat> &v = vertices(texture);
+	for (int i=0;i<16;i++)
+		v.append(quad[i]);
+	nQuads++;
+}
+
+void SpriteBatch::draw()
+{
+	if (nQuads == 0) return;
+	
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	for (int l=0;l<nLayers;l++){
+		QVector<GLfloat> &v = layers.at(l)->vertices;
+		glBindTexture(GL_TEXTURE_2D,layers.at(l)->texture);
+		glVertexPointer(2,GL_FLOAT,4*sizeof(GLfloat),v.constData());
+		glTexCoordPointer(2,GL_FLOAT,4*sizeof(GLfloat),v.constData()+2);
+		glDrawArrays(GL_QUADS,0,v.size()/4);
+		v.resize(0);
+	}
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindTexture(GL_TEXTURE_2D,0);
+	glDisable(GL_TEXTURE_2D);
+	
+	nLayers=0;
+	nQuads=0;
+}
+
+//
+// Private
+//
+
+// The vertices for a texture, starting a new layer if it hasn't been used since the last draw()
+
+QVector<GLfloat> & SpriteBatch::vertices(GLuint texture)
+{
+	for (int l=0;l<nLayers;l++){
+		if (layers.at(l)->texture == texture)
+			return layers.at(l)->vertices;
+	}
+	if (nLayers == layers.size())
+		layers.append(new Layer());
+	Layer *layer = layers.at(nLayers++);
+	layer->texture=texture;
+	layer->vertices.resize(0);
+	return layer->vertices;
+}
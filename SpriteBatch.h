@@ -0,0 +1,67 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __SPRITE_BATCH_H_
+#define __SPRITE_BATCH_H_
+
+#include <GL/gl.h>
+
+#include <QList>
+#include <QVector>
+
+// Textured quads in window coordinates, collected and then drawn together.
+// Quads are grouped by texture, and the groups are drawn in the order their textures were first used,
+// so each draw() costs one draw call per texture however many quads there are.
+
+class SpriteBatch
+{
+	public:
+	
+		SpriteBatch();
+		~SpriteBatch();
+		
+		void add(GLuint,float,float,float,float,float s0=0.0,float t0=0.0,float s1=1.0,float t1=1.0); // x0,y0,x1,y1
+		void add(GLuint,const GLfloat *); // x,y,s,t for each of the four corners, anticlockwise
+		void draw(); // everything queued, which is then cleared
+		
+		int quads() const {return nQuads;} // queued
+		
+	private:
+	
+		class Layer
+		{
+			public:
+				GLuint texture;
+				QVector<GLfloat> vertices; // x,y,s,t
+		};
+		
+		QVector<GLfloat> & vertices(GLuint);
+		
+		QList<Layer *> layers; // kept from frame to frame, so the storage is reused
+		int nLayers; // in use since the last draw()
+		int nQuads;
+};
+
+#endif
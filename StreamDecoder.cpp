@@ -0,0 +1,73 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+
+#include "ConstellationProperties.h"
+#include "GNSSSV.h"
+#include "Observation.h"
+#include "ObservationRing.h"
+#include "StreamDecoder.h"
+
+StreamDecoder::StreamDecoder(QList<ConstellationProperties *> &c,ObservationRing *r):constellations(c)
+{
+	ring=r;
+	nMessages=nBadMessages=nSkipped=nEpochs=nObservations=0;
+}
+
+StreamDecoder::~StreamDecoder()
+{
+}
+
+void StreamDecoder::logStatistics()
+{
+	qInfo() << qPrintable(name()) << ": messages=" << nMessages << " bad=" << nBadMessages << " skipped bytes=" << nSkipped
+		<< " epochs=" << nEpochs << " observations=" << nObservations;
+}
+
+//
+// Protected
+//
+
+// Same rules as for datagrams
+bool StreamDecoder::validate(int c,int prn)
+{
+	if (c<GNSSSV::Beidou || c > GNSSSV::SBAS) return false;
+	ConstellationProperties *cprop = constellations.at(c);
+	if (!cprop->isActive()) return false;
+	return (prn >= cprop->svIDmin && prn <= cprop->svIDmax);
+}
+
+void StreamDecoder::publish(Observation *obs,int nobs)
+{
+	nEpochs++;
+	while (nobs > 0){
+		int n = (nobs > MAX_OBSERVATIONS ? MAX_OBSERVATIONS : nobs);
+		ring->push(obs,n);
+		nObservations += n;
+		obs += n;
+		nobs -= n;
+	}
+}
@@ -0,0 +1,70 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __STREAM_DECODER_H_
+#define __STREAM_DECODER_H_
+
+#include <QList>
+#include <QString>
+
+class ConstellationProperties;
+class Observation;
+class ObservationRing;
+
+// Base class for decoders of receiver output.
+// Data is fed in as it arrives, in arbitrary pieces. Each completed epoch 
+// is pushed to the ObservationRing in one go.
+// Message-oriented sources (UDP) use decodeDatagram(), which by default 
+// treats the datagram as the next piece of the stream.
+
+class StreamDecoder
+{
+	public:
+	
+		StreamDecoder(QList<ConstellationProperties *> &,ObservationRing *);
+		virtual ~StreamDecoder();
+		
+		virtual void decode(const char *,int)=0;
+		virtual void decodeDatagram(const char *buf,int len){decode(buf,len);}
+		virtual QString name()=0;
+		
+		void logStatistics();
+		
+		unsigned long long nMessages;     // good messages
+		unsigned long long nBadMessages;  // bad checksums etc
+		unsigned long long nSkipped;      // bytes discarded while looking for a message
+		unsigned long long nEpochs;
+		unsigned long long nObservations;
+		
+	protected:
+	
+		bool validate(int,int);
+		void publish(Observation *,int);
+		
+		QList<ConstellationProperties *> &constellations;
+		ObservationRing *ring;
+};
+
+#endif
@@ -0,0 +1,107 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "TcpSource.h"
+
+TcpSource::TcpSource(QString h,int p,StreamDecoder *d,QObject *parent):
+	InputSource(QString("tcp:%1:%2").arg(h).arg(p),d,parent)
+{
+	host=h;
+	port=p;
+	backoff=TCP_MIN_BACKOFF;
+	socket=NULL;
+	reconnectTimer=NULL;
+	everConnected=false;
+}
+
+bool TcpSource::open()
+{
+	socket = new QTcpSocket(this);
+	connect(socket,SIGNAL(connected()),this,SLOT(connected()));
+	connect(socket,SIGNAL(disconnected()),this,SLOT(disconnected()));
+	connect(socket,SIGNAL(errorOccurred(QAbstractSocket::SocketError)),this,SLOT(socketError(QAbstractSocket::SocketError)));
+	connect(socket,SIGNAL(readyRead()),this,SLOT(readData()));
+	
+	reconnectTimer = new QTimer(this);
+	reconnectTimer->setSingleShot(true);
+	connect(reconnectTimer,SIGNAL(timeout()),this,SLOT(connectToHost()));
+	
+	connectToHost();
+	return true; // failures are retried
+}
+
+//
+// Private slots
+//
+
+void TcpSource::connectToHost()
+{
+	socket->abort();
+	socket->connectToHost(host,port);
+}
+
+void TcpSource::connected()
+{
+	qInfo() << qPrintable(sourceName) << ": connected";
+	if (everConnected)
+		nReconnects++;
+	everConnected=true;
+	backoff=TCP_MIN_BACKOFF;
+}
+
+void TcpSource::disconnected()
+{
+	qWarning() << qPrintable(sourceName) << ": disconnected";
+	scheduleReconnect();
+}
+
+void TcpSource::socketError(QAbstractSocket::SocketError)
+{
+	nErrors++;
+	qWarning() << qPrintable(sourceName) << ": " << socket->errorString();
+	scheduleReconnect();
+}
+
+void TcpSource::readData()
+{
+	qint64 n;
+	while ((n = socket->read(buf,INPUT_READ_SIZE)) > 0)
+		received(buf,n);
+}
+
+//
+// Private
+//
+
+void TcpSource::scheduleReconnect()
+{
+	if (reconnectTimer->isActive()) return; // an error is often followed by a disconnect
+	reconnectTimer->start(backoff*1000);
+	backoff = qMin(2*backoff,TCP_MAX_BACKOFF);
+}
@@ -0,0 +1,74 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __TCP_SOURCE_H_
+#define __TCP_SOURCE_H_
+
+#include <QAbstractSocket>
+
+#include "InputSource.h"
+
+#define TCP_MIN_BACKOFF 1   // in seconds
+#define TCP_MAX_BACKOFF 64
+
+class QTcpSocket;
+class QTimer;
+
+// A TCP client, for receivers and caster-like relays which serve their output on a port.
+// If the connection can't be made, or is lost, it is retried with exponential backoff.
+
+class TcpSource : public InputSource
+{
+	Q_OBJECT
+	
+	public:
+	
+		TcpSource(QString,int,StreamDecoder *,QObject *parent=0);
+		
+		virtual bool open();
+		
+	private slots:
+	
+		void connectToHost();
+		void connected();
+		void disconnected();
+		void socketError(QAbstractSocket::SocketError);
+		void readData();
+		
+	private:
+	
+		void scheduleReconnect();
+		
+		QString host;
+		int     port;
+		int     backoff; // in seconds
+		bool    everConnected; // so that only later connections count as reconnects
+		
+		QTcpSocket *socket;
+		QTimer *reconnectTimer;
+		char buf[INPUT_READ_SIZE];
+};
+
+#endif
@@ -0,0 +1,213 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdio.h>
+#include <string.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include "TrackArchive.h"
+
+TrackArchive::TrackArchive(const QString &d,int days)
+{
+	dir = d;
+	retention = (days > 0 ? days : ARCHIVE_DAYS)*86400;
+	lastPrune = QDateTime::currentDateTime().toTime_t();
+	revision=0;
+	open = QDir().mkpath(dir);
+	for (int l=0;l<ARCHIVE_LEVELS;l++){
+		Level &lv = levels[l];
+		lv.file=NULL;
+		lv.map=NULL;
+		lv.count=0;
+		lv.lastTime=0;
+		for (int s=0;s<ARCHIVE_SLOTS;s++)
+			lv.lastBucket[s]=-1;
+		if (open)
+			open = openLevel(l);
+	}
+	if (!open){
+		qWarning() << "TrackArchive: can't use" << dir;
+		return;
+	}
+	for (int l=0;l<ARCHIVE_LEVELS;l++)
+		prune(l);
+}
+
+TrackArchive::~TrackArchive()
+{
+	flush();
+	for (int l=0;l<ARCHIVE_LEVELS;l++){
+		if (levels[l].map)
+			levels[l].file->unmap((uchar *) levels[l].map);
+		delete levels[l].file;
+	}
+}
+
+// Each level takes the first observation of a satellite in each of its buckets
+
+void TrackArchive::add(int c,int prn,int t,float az,float el)
+{
+	if (!open || prn < 0 || prn >= ARCHIVE_MAX_PRN) return;
+	int slot = c*ARCHIVE_MAX_PRN + prn;
+	for (int l=0;l<ARCHIVE_LEVELS;l++){
+		Level &lv = levels[l];
+		int b = t/bucket(l);
+		if (b == lv.lastBucket[slot] || t < lv.lastTime) // already have one, or out of order
+			continue;
+		lv.lastBucket[slot]=b;
+		lv.lastTime=t;
+		ArchiveRecord r;
+		r.time=t;
+		r.constellation=c;
+		r.PRN=prn;
+		r.az=qBound(0,qRound(az*100.0),36000);
+		r.elev=qBound(-9000,qRound(el*100.0),9000);
+		r.reserved=0;
+		lv.pending.append(r);
+	}
+}
+
+void TrackArchive::flush()
+{
+	if (!open) return;
+	for (int l=0;l<ARCHIVE_LEVELS;l++){
+		Level &lv = levels[l];
+		if (lv.pending.isEmpty()) continue;
+		lv.file->seek(lv.file->size());
+		lv.file->write((const char *) lv.pending.constData(),lv.pending.size()*sizeof(ArchiveRecord));
+		lv.file->flush();
+		lv.pending.clear();
+		remap(l);
+		revision++;
+	}
+	int now = QDateTime::currentDateTime().toTime_t();
+	if (now - lastPrune > 86400){
+		for (int l=0;l<ARCHIVE_LEVELS;l++)
+			prune(l);
+		lastPrune=now;
+		revision++;
+	}
+}
+
+int TrackArchive::level(int from,int to,int budget) const
+{
+	for (int l=0;l<ARCHIVE_LEVELS;l++){
+		if (lowerBound(l,to+1) - lowerBound(l,from) <= budget)
+			return l;
+	}
+	return ARCHIVE_LEVELS-1;
+}
+
+const ArchiveRecord *TrackArchive::records(int l,int from,int to,int *n) const
+{
+	int first = lowerBound(l,from);
+	*n = lowerBound(l,to+1) - first;
+	return (*n > 0 ? levels[l].map + first : NULL);
+}
+
+//
+// Private
+//
+
+bool TrackArchive::openLevel(int l)
+{
+	Level &lv = levels[l];
+	lv.file = new QFile(QString("%1/level%2.dat").arg(dir).arg(l));
+	if (!lv.file->open(QIODevice::ReadWrite)){
+		qWarning() << "TrackArchive: can't open" << lv.file->fileName() << ":" << lv.file->errorString();
+		return false;
+	}
+	qint64 sz = lv.file->size();
+	if (sz % sizeof(ArchiveRecord)) // a partial record from a crash
+		lv.file->resize(sz - sz % sizeof(ArchiveRecord));
+	remap(l);
+	if (lv.count > 0)
+		lv.lastTime = lv.map[lv.count-1].time;
+	return true;
+}
+
+void TrackArchive::remap(int l)
+{
+	Level &lv = levels[l];
+	if (lv.map)
+		lv.file->unmap((uchar *) lv.map);
+	lv.map=NULL;
+	lv.count = lv.file->size()/sizeof(ArchiveRecord);
+	if (lv.count > 0)
+		lv.map = (const ArchiveRecord *) lv.file->map(0,(qint64) lv.count*sizeof(ArchiveRecord));
+	if (!lv.map)
+		lv.count=0;
+}
+
+// Drops records older than the retention time, by copying the rest to a new file 
+// which then replaces the old one
+
+void TrackArchive::prune(int l)
+{
+	Level &lv = levels[l];
+	int cutoff = lowerBound(l,QDateTime::currentDateTime().toTime_t() - retention);
+	if (cutoff == 0) return;
+	QString fname = lv.file->fileName();
+	QFile tmp(fname + ".tmp");
+	if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+		qWarning() << "TrackArchive: can't prune" << fname;
+		return;
+	}
+	tmp.write((const char *) (lv.map + cutoff),(qint64) (lv.count - cutoff)*sizeof(ArchiveRecord));
+	tmp.close();
+	if (::rename(qPrintable(tmp.fileName()),qPrintable(fname))){ // atomically
+		qWarning() << "TrackArchive: can't prune" << fname;
+		return;
+	}
+	if (lv.map)
+		lv.file->unmap((uchar *) lv.map);
+	lv.map=NULL;
+	lv.file->close();
+	delete lv.file;
+	lv.file=NULL;
+	if (!openLevel(l))
+		open=false;
+	qDebug() << "TrackArchive: pruned" << cutoff << "records from" << fname;
+}
+
+// The first record at or after time t
+
+int TrackArchive::lowerBound(int l,int t) const
+{
+	const Level &lv = levels[l];
+	int lo=0,hi=lv.count;
+	while (lo < hi){
+		int mid = (lo+hi)/2;
+		if (lv.map[mid].time < t)
+			lo=mid+1;
+		else
+			hi=mid;
+	}
+	return lo;
+}
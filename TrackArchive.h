@@ -0,0 +1,103 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __TRACK_ARCHIVE_H_
+#define __TRACK_ARCHIVE_H_
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+class QFile;
+
+#define ARCHIVE_LEVELS       5
+#define ARCHIVE_BASE_BUCKET  10    // seconds, for level 0. Each level is 4 times coarser
+#define ARCHIVE_DAYS         7     // default retention
+#define ARCHIVE_POINT_BUDGET 20000 // records drawn, whatever the span
+#define ARCHIVE_MAX_PRN      64
+#define ARCHIVE_SLOTS        (6*ARCHIVE_MAX_PRN) // constellations x PRNs
+
+struct ArchiveRecord // 12 bytes
+{
+	qint32  time;     // UNIX
+	quint8  constellation;
+	quint8  PRN;
+	quint16 az;       // centidegrees
+	qint16  elev;     // centidegrees
+	qint16  reserved;
+};
+
+// Satellite positions over several days, on disk, for the coverage underlay.
+// Every observation is offered to each level of detail, and a level keeps one record per 
+// satellite per time bucket, so a coarse level has a fraction of the records of a fine one.
+// Each level is a file of records in time order, appended to and memory-mapped for reading.
+// The renderer picks the finest level which fits its budget for the span shown, so drawing 
+// a week costs about the same as drawing an hour.
+
+class TrackArchive
+{
+	public:
+	
+		TrackArchive(const QString &,int);
+		~TrackArchive();
+		
+		bool isOpen(){return open;}
+		
+		void add(int,int,int,float,float);
+		void flush(); // writes what's been added
+		
+		int level(int,int,int) const; // the finest level with at most a given number of records in a time span
+		const ArchiveRecord *records(int,int,int,int *) const; // those in a time span
+		
+		static int bucket(int level){return ARCHIVE_BASE_BUCKET << (2*level);} // in seconds
+		
+		int revision; // changes whenever records are written or pruned, so that readers know to look again
+		
+	private:
+	
+		class Level
+		{
+			public:
+				QFile *file;
+				const ArchiveRecord *map;
+				int count;
+				int lastTime;
+				QVector<ArchiveRecord> pending;
+				int lastBucket[ARCHIVE_SLOTS];
+		};
+		
+		bool openLevel(int);
+		void remap(int);
+		void prune(int);
+		int  lowerBound(int,int) const;
+		
+		Level levels[ARCHIVE_LEVELS];
+		QString dir;
+		int retention; // in seconds
+		int lastPrune;
+		bool open;
+};
+
+#endif
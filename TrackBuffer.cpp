@@ -0,0 +1,152 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <QDebug>
+#include <QGLShaderProgram>
+
+#include "TrackBuffer.h"
+#include "TrackGeometry.h"
+
+// The fade along the track is done here rather than by setting a colour for each vertex
+static const char *vertexShader = 
+	"attribute vec2 vertex;\n"
+	"attribute float index;\n"
+	"uniform vec3 colour;\n"
+	"uniform float offset;\n" // azimuth shift
+	"uniform float first;\n" // index of the first vertex drawn
+	"uniform float count;\n"
+	"varying vec4 fragColour;\n"
+	"void main()\n"
+	"{\n"
+	"	float alpha = (count > 1.0 ? 0.1 + 0.9*(index-first)/(count-1.0) : 0.1);\n"
+	"	fragColour = vec4(colour,alpha);\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix*vec4(vertex.x+offset,vertex.y,0.0,1.0);\n"
+	"}\n";
+
+static const char *fragmentShader =
+	"varying vec4 fragColour;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = fragColour;\n"
+	"}\n";
+
+TrackBuffer::TrackBuffer():vbo(QGLBuffer::VertexBuffer)
+{
+	azMin=azMax=0.0;
+	frame=0;
+	geometryId=0;
+	base=count=capacity=0;
+	settled=0;
+	vbo.setUsagePattern(QGLBuffer::DynamicDraw);
+}
+
+TrackBuffer::~TrackBuffer()
+{
+	vbo.destroy();
+}
+
+bool TrackBuffer::update(const TrackGeometry &g)
+{
+	if (!vbo.isCreated() && !vbo.create()){
+		qWarning() << "TrackBuffer: couldn't create a vertex buffer";
+		return false;
+	}
+	
+	int first = g.dropped();
+	int end = first + g.size();
+	int from;
+	if (g.serial() != geometryId || end - base > capacity){ // start again
+		capacity = TRACK_BUFFER_MIN;
+		while (capacity < 2*g.size())
+			capacity *= 2;
+		base=first;
+		from=first;
+		vbo.bind();
+		vbo.allocate(capacity*sizeof(TrackVertex));
+		geometryId=g.serial();
+		azMin=1.0E6;
+		azMax=-1.0E6;
+	}
+	else{
+		from = qMax(settled,first);
+		vbo.bind();
+	}
+	
+	int n = end-from;
+	if (n > 0){
+		staging.resize(n);
+		TrackVertex *v = staging.data();
+		const float *az = g.az() + (from-first);
+		const float *el = g.elev() + (from-first);
+		for (int i=0;i<n;i++){
+			v[i].az=az[i];
+			v[i].elev=el[i];
+			v[i].index=from-base+i;
+			if (az[i] < azMin) azMin=az[i];
+			if (az[i] > azMax) azMax=az[i];
+		}
+		vbo.write((from-base)*sizeof(TrackVertex),v,n*sizeof(TrackVertex));
+	}
+	vbo.release();
+	
+	count = end-base;
+	settled = g.settled();
+	return true;
+}
+
+void TrackBuffer::draw(QGLShaderProgram *program,const TrackGeometry &g,int n,float offset)
+{
+	int first = g.dropped()-base;
+	if (n <= 0 || first+n > count) return;
+	vbo.bind();
+	program->setAttributeBuffer("vertex",GL_FLOAT,0,2,sizeof(TrackVertex));
+	program->setAttributeBuffer("index",GL_FLOAT,2*sizeof(float),1,sizeof(TrackVertex));
+	program->enableAttributeArray("vertex");
+	program->enableAttributeArray("index");
+	program->setUniformValue("offset",offset);
+	program->setUniformValue("first",(GLfloat) first);
+	program->setUniformValue("count",(GLfloat) n);
+	glDrawArrays(GL_LINE_STRIP,first,n);
+	program->disableAttributeArray("vertex");
+	program->disableAttributeArray("index");
+	vbo.release();
+}
+
+QGLShaderProgram *TrackBuffer::makeProgram(QObject *parent)
+{
+	if (!QGLShaderProgram::hasOpenGLShaderPrograms()){
+		qWarning() << "TrackBuffer: no shaders, so tracks will be drawn in immediate mode";
+		return NULL;
+	}
+	QGLShaderProgram *program = new QGLShaderProgram(parent);
+	if (!program->addShaderFromSourceCode(QGLShader::Vertex,vertexShader) ||
+		!program->addShaderFromSourceCode(QGLShader::Fragment,fragmentShader) ||
+		!program->link()){
+		qWarning() << "TrackBuffer: couldn't build the track shader:" << program->log();
+		delete program;
+		return NULL;
+	}
+	return program;
+}
@@ -0,0 +1,78 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __TRACK_BUFFER_H_
+#define __TRACK_BUFFER_H_
+
+#include <QGLBuffer>
+#include <QVector>
+
+class QGLShaderProgram;
+class TrackGeometry;
+
+#define TRACK_BUFFER_MIN 512 // vertices
+
+// A vertex as it is kept on the GPU.
+// The index counts from the start of the buffer, so that the fade along the track can be computed in the shader.
+
+struct TrackVertex
+{
+	float az,elev;
+	float index;
+};
+
+// A copy of a track's vertices in a vertex buffer object.
+// Only the vertices which are new, or which the smoothing may have changed, are uploaded on each update.
+// Vertices dropped from the start of the track are left in place until the buffer fills up, and then the 
+// buffer is rebuilt from what's left.
+// Must be used, and deleted, with the GL context current.
+
+class TrackBuffer
+{
+	public:
+	
+		TrackBuffer();
+		~TrackBuffer();
+		
+		bool update(const TrackGeometry &); // false if there's no buffer
+		void draw(QGLShaderProgram *,const TrackGeometry &,int,float); // the first n vertices, shifted in azimuth
+		
+		float azMin,azMax; // bounds of the vertices in the buffer, for culling
+		int frame; // when it was last drawn
+		
+		static QGLShaderProgram *makeProgram(QObject *); // NULL if shaders can't be used
+		
+	private:
+	
+		QGLBuffer vbo;
+		int geometryId; // of the geometry copied
+		int base; // geometry vertex at the start of the buffer
+		int count,capacity;
+		int settled; // geometry vertices which were final when they were uploaded
+		
+		QVector<TrackVertex> staging;
+};
+
+#endif
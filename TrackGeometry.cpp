@@ -0,0 +1,283 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <string.h>
+#include <cmath>
+
+#include <QDebug>
+
+#include "SlabPool.h"
+#include "TrackGeometry.h"
+
+int TrackGeometry::kernel=TrackGeometry::MovingAverage;
+int TrackGeometry::width=SMOOTH_WIDTH;
+int TrackGeometry::subdivisions=SMOOTH_SUBDIVISIONS;
+SlabPool *TrackGeometry::pools[GEOMETRY_CHUNK_CLASSES];
+int TrackGeometry::nextId=0;
+
+// Azimuth difference, allowing for wrapping at 360
+static inline float dAz(float a,float b)
+{
+	float d = a-b;
+	if (d > 180.0) d -= 360.0;
+	else if (d < -180.0) d += 360.0;
+	return d;
+}
+
+TrackGeometry::TrackGeometry()
+{
+	buf=NULL;
+	capacity=0;
+	chunkClass=-1;
+	first=n=0;
+	rawCount=rawDropped=0;
+	id=++nextId;
+	nDropped=0;
+}
+
+TrackGeometry::TrackGeometry(const TrackGeometry &g)
+{
+	buf=NULL;
+	capacity=0;
+	chunkClass=-1;
+	id=++nextId;
+	*this = g;
+}
+
+TrackGeometry::~TrackGeometry()
+{
+	releaseChunk();
+}
+
+TrackGeometry & TrackGeometry::operator=(const TrackGeometry &g)
+{
+	if (this == &g) return *this;
+	releaseChunk();
+	first=n=0;
+	if (g.n > 0){
+		reserve(g.n);
+		memcpy(buf,g.az(),g.n*sizeof(float));
+		memcpy(buf+capacity,g.elev(),g.n*sizeof(float));
+	}
+	n=g.n;
+	rawCount=g.rawCount;
+	rawDropped=g.rawDropped;
+	nDropped=g.nDropped;
+	id=++nextId; // the copy may go its own way
+	return *this;
+}
+
+SlabPool *TrackGeometry::chunkPool(int cls)
+{
+	return (cls >= 0 && cls < GEOMETRY_CHUNK_CLASSES ? pools[cls] : NULL);
+}
+
+void TrackGeometry::setKernel(int k,int param)
+{
+	kernel=k;
+	switch (kernel)
+	{
+		case MovingAverage:
+			width = (param > 0 ? param : SMOOTH_WIDTH);
+			if (width % 2 == 0){
+				width++;
+				qWarning() << "TrackGeometry: the moving average must be an odd number of points, using" << width;
+			}
+			break;
+		case CatmullRom:
+			subdivisions = (param > 0 ? param : SMOOTH_SUBDIVISIONS);
+			break;
+		default:
+			kernel=None;
+			break;
+	}
+}
+
+void TrackGeometry::update(const Track &track)
+{
+	int K = (kernel == CatmullRom ? subdivisions : 1); // vertices per track segment
+	
+	// drop the vertices for points which have gone from the start of the track
+	int drop = track.dropped() - rawDropped;
+	if (drop > 0){
+		if (drop >= rawCount){
+			nDropped += n;
+			first=n=0;
+			rawCount=0;
+		}
+		else{
+			first += drop*K;
+			n -= drop*K;
+			nDropped += drop*K;
+			rawCount -= drop;
+		}
+	}
+	rawDropped=track.dropped();
+	
+	// The newest point may have been moved by the simplifier, so it and anything after it has changed.
+	// Vertices within the reach of the kernel have to be recomputed.
+	int changed = (rawCount > 0 ? rawCount-1 : 0);
+	int from = changed;
+	if (kernel == MovingAverage)
+		from -= width/2;
+	else if (kernel == CatmullRom)
+		from -= 2;
+	if (from < 0) from=0;
+	
+	rawCount=track.size();
+	compute(track,from);
+}
+
+int TrackGeometry::settled() const
+{
+	int K = (kernel == CatmullRom ? subdivisions : 1);
+	int reach = 0; // of the kernel, in track points
+	if (kernel == MovingAverage)
+		reach = width/2;
+	else if (kernel == CatmullRom)
+		reach = 2;
+	int from = rawCount-1-reach; // where the next update will start recomputing
+	if (from < 0) from=0;
+	return nDropped + from*K;
+}
+
+//
+// Private
+//
+
+// Recomputes the vertices from the given track point on
+
+void TrackGeometry::compute(const Track &track,int from)
+{
+	int npts = rawCount;
+	if (npts == 0){
+		n=0;
+		return;
+	}
+	
+	int K = (kernel == CatmullRom ? subdivisions : 1);
+	int total = (npts-1)*K+1;
+	reserve(total);
+	float *oaz = buf+first;
+	float *oel = buf+capacity+first;
+	
+	for (int b=from;b<npts;b++){
+		int o = b*K; // first vertex for this point
+		int nv = (b == npts-1 ? 1 : K);
+		
+		float a[4],e[4]; // unwrapped, relative to point b
+		for (int k=0;k<nv;k++){
+			float va,ve;
+			if (kernel == MovingAverage){
+				int h = qMin(width/2,qMin(b,npts-1-b)); // the window shrinks at the ends
+				float sa=0.0,se=track.elev(b);
+				float u=0.0;
+				for (int j=b+1;j<=b+h;j++){
+					u += dAz(track.az(j),track.az(j-1));
+					sa += u;
+					se += track.elev(j);
+				}
+				u=0.0;
+				for (int j=b-1;j>=b-h;j--){
+					u += dAz(track.az(j),track.az(j+1));
+					sa += u;
+					se += track.elev(j);
+				}
+				va = track.az(b) + sa/(2*h+1);
+				ve = se/(2*h+1);
+			}
+			else if (kernel == CatmullRom && nv > 1){
+				if (k == 0){
+					int i0 = (b > 0 ? b-1 : b);
+					int i3 = (b+2 < npts ? b+2 : b+1);
+					a[1]=0.0;
+					a[0]=dAz(track.az(i0),track.az(b));
+					a[2]=dAz(track.az(b+1),track.az(b));
+					a[3]=a[2]+dAz(track.az(i3),track.az(b+1));
+					e[0]=track.elev(i0);e[1]=track.elev(b);e[2]=track.elev(b+1);e[3]=track.elev(i3);
+				}
+				float t = (float) k/K;
+				float t2=t*t,t3=t2*t;
+				va = track.az(b) + 0.5*(2.0*a[1] + (a[2]-a[0])*t + (2.0*a[0]-5.0*a[1]+4.0*a[2]-a[3])*t2 +
+					(3.0*a[1]-a[0]-3.0*a[2]+a[3])*t3);
+				ve = 0.5*(2.0*e[1] + (e[2]-e[0])*t + (2.0*e[0]-5.0*e[1]+4.0*e[2]-e[3])*t2 +
+					(3.0*e[1]-e[0]-3.0*e[2]+e[3])*t3);
+			}
+			else{
+				va=track.az(b);
+				ve=track.elev(b);
+			}
+			// keep azimuth continuous with the previous vertex
+			if (o+k > 0)
+				va += 360.0*floor((oaz[o+k-1]-va)/360.0 + 0.5);
+			oaz[o+k]=va;
+			oel[o+k]=ve;
+		}
+	}
+	n=total;
+}
+
+// Makes room for the given number of vertices after the first
+
+void TrackGeometry::reserve(int total)
+{
+	if (first+total <= capacity)
+		return;
+	if (first >= n && total <= capacity){ // more dropped than kept, so move back to the start
+		memmove(buf,buf+first,n*sizeof(float));
+		memmove(buf+capacity,buf+capacity+first,n*sizeof(float));
+		first=0;
+		return;
+	}
+	
+	// a bigger chunk
+	int cls=0;
+	while (cls < GEOMETRY_CHUNK_CLASSES-1 && (GEOMETRY_MIN_CHUNK << cls) < total)
+		cls++;
+	if ((GEOMETRY_MIN_CHUNK << cls) < total)
+		qFatal("TrackGeometry: track too long");
+	if (!pools[cls])
+		pools[cls] = new SlabPool(2*(GEOMETRY_MIN_CHUNK << cls)*sizeof(float));
+	float *chunk = (float *) pools[cls]->allocate();
+	int cap = GEOMETRY_MIN_CHUNK << cls;
+	if (buf){
+		memcpy(chunk,buf+first,n*sizeof(float));
+		memcpy(chunk+cap,buf+capacity+first,n*sizeof(float));
+	}
+	releaseChunk();
+	buf=chunk;
+	capacity=cap;
+	chunkClass=cls;
+	first=0;
+}
+
+void TrackGeometry::releaseChunk()
+{
+	if (buf)
+		pools[chunkClass]->release(buf);
+	buf=NULL;
+	capacity=0;
+	chunkClass=-1;
+}
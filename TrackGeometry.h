@@ -0,0 +1,91 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __TRACK_GEOMETRY_H_
+#define __TRACK_GEOMETRY_H_
+
+#include "TrackStore.h"
+
+class SlabPool;
+
+#define SMOOTH_WIDTH        3 // points in the moving average (odd)
+#define SMOOTH_SUBDIVISIONS 4 // segments per track segment, for Catmull-Rom
+
+#define GEOMETRY_MIN_CHUNK 256 // vertices
+#define GEOMETRY_CHUNK_CLASSES 16 // chunks are GEOMETRY_MIN_CHUNK << class vertices
+
+// The vertices actually drawn for a track, kept up to date as the track grows.
+// Each new, or moved, point only recomputes the tail of the output, and points dropped 
+// from the start of the track just drop the corresponding vertices, so the renderer 
+// gets ready-made vertices and smoothing costs nothing per frame.
+// Azimuth is unwrapped, that is, continuous across 0/360, so it may lie outside [0,360).
+// The vertices are kept in a chunk from a pool for its size class, and chunks are recycled.
+
+class TrackGeometry
+{
+	public:
+	
+		enum Kernel {None=0,MovingAverage=1,CatmullRom=2};
+		
+		TrackGeometry();
+		TrackGeometry(const TrackGeometry &);
+		~TrackGeometry();
+		
+		TrackGeometry & operator=(const TrackGeometry &);
+		
+		void update(const Track &); // after the track has changed
+		
+		int size() const {return n;}
+		int vertices(int points) const {return points > 0 ? (points-1)*(kernel == CatmullRom ? subdivisions : 1)+1 : 0;} // for the first points of the track
+		const float *az() const {return buf+first;}
+		const float *elev() const {return buf+capacity+first;}
+		
+		// for copying the vertices elsewhere incrementally, eg to the GPU
+		int serial() const {return id;} // different for every geometry
+		int dropped() const {return nDropped;} // vertices dropped from the start, ever
+		int settled() const; // vertices, counting dropped ones, which no later update will change
+		
+		static void setKernel(int,int); // before any tracks are made
+		static SlabPool *chunkPool(int); // NULL if the class hasn't been used
+		static int kernel;
+		static int width,subdivisions;
+		
+	private:
+	
+		void compute(const Track &,int);
+		void reserve(int);
+		void releaseChunk();
+		
+		float *buf; // azimuth then elevation, each of capacity
+		int capacity,chunkClass;
+		int first,n;
+		int rawCount,rawDropped; // the state of the track when last updated
+		int id,nDropped;
+		
+		static int nextId;
+		static SlabPool *pools[GEOMETRY_CHUNK_CLASSES]; // made as needed, and kept
+};
+
+#endif
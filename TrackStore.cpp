@@ -0,0 +1,462 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/file.h>
+#include <algorithm>
+#include <atomic>
+
+#include <QDebug>
+#include <QFile>
+#include <QtGlobal>
+
+#include "TrackStore.h"
+
+TrackStore::TrackStore()
+{
+	base=NULL;
+	file=NULL;
+	header=NULL;
+	records=NULL;
+	azBuf=elBuf=NULL;
+	tBuf=NULL;
+	nSlots=0;
+	stride=0;
+	maxInUse=0;
+	encoding=Float;
+	coordSize=sizeof(float);
+	setLimits(TRACK_MAX_POINTS,TRACK_MAX_AGE);
+}
+
+TrackStore::~TrackStore()
+{
+	close();
+}
+
+void TrackStore::setLimits(int points,int age)
+{
+	if (base){
+		qWarning() << "TrackStore: limits can't be changed once in use";
+		return;
+	}
+	limitPoints = (points > 0 ? points : TRACK_MAX_POINTS);
+	limitAge = age;
+	int n = TRACK_ALIGNMENT/sizeof(float);
+	stride = ((2*limitPoints + n - 1)/n)*n; // so that every slot is aligned too
+}
+
+void TrackStore::setEncoding(int e)
+{
+	if (base){
+		qWarning() << "TrackStore: the encoding can't be changed once in use";
+		return;
+	}
+	encoding = (e == Centidegrees ? Centidegrees : Float);
+	coordSize = (encoding == Centidegrees ? sizeof(qint16) : sizeof(float));
+}
+
+// Keeps the store in the file, restoring what's there if it is intact and has the same limits
+
+bool TrackStore::open(const QString &fname)
+{
+	if (base){
+		qWarning() << "TrackStore: can't open" << fname << "once in use";
+		return false;
+	}
+	file = new QFile(fname);
+	if (!file->open(QIODevice::ReadWrite)){
+		qWarning() << "TrackStore: can't open" << fname << ":" << file->errorString();
+		delete file;
+		file=NULL;
+		return false;
+	}
+	// two processes mapping the same file would corrupt each other's tracks
+	if (flock(file->handle(),LOCK_EX | LOCK_NB) < 0){
+		qWarning() << "TrackStore: can't lock" << fname << "- is another gnssview using it?";
+		file->close(); // which releases any lock
+		delete file;
+		file=NULL;
+		return false;
+	}
+	if (restore()){
+		qInfo() << "TrackStore: restored" << restored.size() << "tracks from" << fname;
+		return true;
+	}
+	
+	// start afresh, forgetting everything in the rejected mapping
+	if (base)
+		file->unmap((uchar *) base);
+	base=NULL;
+	header=NULL;
+	records=NULL;
+	azBuf=elBuf=NULL;
+	tBuf=NULL;
+	nSlots=0;
+	file->resize(0);
+	grow();
+	return base != NULL;
+}
+
+// Leaves the file as it is, so that slots still held are restored next time, and unlocks it.
+// Releasing a slot afterwards has no effect.
+
+void TrackStore::close()
+{
+	if (file){
+		if (base)
+			file->unmap((uchar *) base);
+		file->close();
+		delete file;
+		file=NULL;
+	}
+	else
+		qFreeAligned(base);
+	base=NULL;
+	header=NULL;
+	records=NULL;
+	azBuf=elBuf=NULL;
+	tBuf=NULL;
+}
+
+int TrackStore::allocate()
+{
+	if (freeSlots.isEmpty())
+		grow();
+	int slot = freeSlots.last();
+	freeSlots.removeLast();
+	if (slotsInUse() > maxInUse)
+		maxInUse = slotsInUse();
+	beginChange(slot);
+	TrackSlot &s = records[slot];
+	s.inUse=1;
+	s.constellation=-1;
+	s.PRN=-1;
+	s.t0=0;
+	s.first=0;
+	s.count=0;
+	s.dropped=0;
+	s.sn=0.0;
+	endChange(slot);
+	return slot;
+}
+
+void TrackStore::release(int slot)
+{
+	if (!base) return;
+	beginChange(slot);
+	records[slot].inUse=0;
+	endChange(slot);
+	freeSlots.append(slot);
+}
+
+// Allocates a new slot with a copy of the points in another
+
+int TrackStore::duplicate(int src)
+{
+	int slot = allocate(); // may move the arrays
+	int n = records[src].count;
+	beginChange(slot);
+	memcpy(azBuf + index(slot,0)*coordSize,azBuf + index(src,0)*coordSize,n*coordSize);
+	memcpy(elBuf + index(slot,0)*coordSize,elBuf + index(src,0)*coordSize,n*coordSize);
+	memcpy(tBuf + slot*stride,tBuf + src*stride + records[src].first,n*sizeof(quint16));
+	TrackSlot &s = records[slot];
+	s.constellation=records[src].constellation;
+	s.PRN=records[src].PRN;
+	s.t0=records[src].t0;
+	s.count=n;
+	s.dropped=records[src].dropped;
+	s.sn=records[src].sn;
+	endChange(slot);
+	return slot;
+}
+
+void TrackStore::append(int slot,float a,float e,int t)
+{
+	int offset = slot*stride;
+	TrackSlot &s = records[slot];
+	beginChange(slot);
+	
+	if (s.count == limitPoints) // full, so drop the oldest
+		dropOldest(slot);
+	if (s.count == 0)
+		s.t0=t;
+	else if ((t - s.t0)/TRACK_TIME_UNIT > TRACK_MAX_TICKS)
+		rebase(slot,t);
+	if (s.first+s.count == stride){ // at the end of the slot, so move back to the start
+		memmove(azBuf + offset*coordSize,azBuf + (offset + s.first)*coordSize,s.count*coordSize);
+		memmove(elBuf + offset*coordSize,elBuf + (offset + s.first)*coordSize,s.count*coordSize);
+		memmove(tBuf + offset,tBuf + offset + s.first,s.count*sizeof(quint16));
+		s.first=0;
+	}
+	int i = offset + s.first + s.count;
+	setCoords(i,a,e);
+	tBuf[i]=qMax((t - s.t0)/TRACK_TIME_UNIT,0);
+	s.count++;
+	
+	if (limitAge > 0){
+		while (s.count > 1 && t - time(slot,0) > limitAge)
+			dropOldest(slot);
+	}
+	endChange(slot);
+}
+
+// Moves the newest point, for the simplifier
+
+void TrackStore::replaceLast(int slot,float a,float e,int t)
+{
+	TrackSlot &s = records[slot];
+	beginChange(slot);
+	if ((t - s.t0)/TRACK_TIME_UNIT > TRACK_MAX_TICKS){
+		rebase(slot,t);
+		if (s.count == 0){ // nothing left to replace
+			endChange(slot);
+			append(slot,a,e,t);
+			return;
+		}
+	}
+	int i = slot*stride + s.first + s.count - 1;
+	setCoords(i,a,e);
+	tBuf[i]=qMax((t - s.t0)/TRACK_TIME_UNIT,0);
+	endChange(slot);
+}
+
+// Binary search for the number of points at or before time t
+
+int TrackStore::pointsAt(int slot,int t) const
+{
+	const TrackSlot &s = records[slot];
+	if (s.count == 0 || t < s.t0)
+		return 0;
+	int d = (t - s.t0)/TRACK_TIME_UNIT;
+	if (d > TRACK_MAX_TICKS)
+		return s.count;
+	const quint16 *ticks = tBuf + slot*stride + s.first;
+	return std::upper_bound(ticks,ticks + s.count,(quint16) d) - ticks;
+}
+
+void TrackStore::setIdentity(int slot,int c,int prn)
+{
+	beginChange(slot);
+	records[slot].constellation=c;
+	records[slot].PRN=prn;
+	endChange(slot);
+}
+
+void TrackStore::setSignal(int slot,float sn)
+{
+	records[slot].sn=sn; // a torn write is harmless
+}
+
+QList<int> TrackStore::takeRestored()
+{
+	QList<int> r = restored;
+	restored.clear();
+	return r;
+}
+
+//
+// Private
+//
+
+void TrackStore::grow()
+{
+	int newSlots = (nSlots == 0 ? TRACK_INIT_SLOTS : 2*nSlots);
+	size_t oldSize = (nSlots == 0 ? 0 : storeSize(nSlots));
+	size_t newSize = storeSize(newSlots);
+	
+	if (file){
+		if (base){
+			header->valid=0; // until the arrays are in their new places
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			file->unmap((uchar *) base);
+			base=NULL;
+		}
+		if (!file->resize(newSize) || !(base = (char *) file->map(0,newSize))){
+			qWarning() << "TrackStore: can't map" << file->fileName() << ":" << file->errorString();
+			qFatal("TrackStore: out of track storage");
+		}
+	}
+	else{
+		base = (char *) qReallocAligned(base,newSize,oldSize,TRACK_ALIGNMENT);
+		if (!base)
+			qFatal("TrackStore: out of track storage");
+	}
+	
+	header = (TrackHeader *) base;
+	if (nSlots > 0)
+		moveArrays(nSlots,newSlots);
+	else
+		memset(base,0,sizeof(TrackHeader));
+	records = (TrackSlot *) (base + sizeof(TrackHeader));
+	memset(records + nSlots,0,(newSlots-nSlots)*sizeof(TrackSlot));
+	
+	memcpy(header->magic,TRACK_FILE_MAGIC,sizeof(header->magic));
+	header->version=TRACK_FILE_VERSION;
+	header->maxPoints=limitPoints;
+	header->stride=stride;
+	header->nSlots=newSlots;
+	header->timeUnit=TRACK_TIME_UNIT;
+	header->encoding=encoding;
+	header->checksum=headerChecksum();
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	header->valid=1;
+	
+	for (int s=newSlots-1;s>=nSlots;s--) // so that the lowest are used first
+		freeSlots.append(s);
+	nSlots=newSlots;
+	layout();
+}
+
+// Maps the whole file and checks that it is a store with the same limits
+
+bool TrackStore::restore()
+{
+	if (file->size() < (qint64) sizeof(TrackHeader))
+		return false;
+	qint64 fsize = file->size();
+	base = (char *) file->map(0,fsize);
+	if (!base)
+		return false;
+	header = (TrackHeader *) base;
+	if (memcmp(header->magic,TRACK_FILE_MAGIC,sizeof(header->magic)) || header->version != TRACK_FILE_VERSION ||
+		!header->valid || header->checksum != headerChecksum()){
+		qWarning() << "TrackStore: ignoring" << file->fileName() << "(not intact)";
+		return false;
+	}
+	if (header->maxPoints != limitPoints || header->stride != stride || header->timeUnit != TRACK_TIME_UNIT || header->encoding != encoding ||
+		header->nSlots <= 0 || (qint64) storeSize(header->nSlots) != fsize){
+		qWarning() << "TrackStore: ignoring" << file->fileName() << "(different limits)";
+		return false;
+	}
+	
+	nSlots=header->nSlots;
+	layout();
+	for (int s=nSlots-1;s>=0;s--){
+		TrackSlot &ts = records[s];
+		bool ok = ts.inUse && !(ts.seq & 1) && ts.count > 0 && ts.first >= 0 && ts.first+ts.count <= stride &&
+			ts.constellation >= 0 && ts.PRN >= 0; // the caller checks them against the constellations
+		if (ok)
+			restored.append(s);
+		else{
+			if (ts.inUse && (ts.seq & 1))
+				qWarning() << "TrackStore: discarding a track caught mid-change";
+			ts.inUse=0;
+			ts.seq=0;
+			freeSlots.append(s);
+		}
+	}
+	maxInUse = restored.size();
+	return true;
+}
+
+void TrackStore::setCoords(size_t i,float a,float e)
+{
+	if (encoding == Centidegrees){
+		((quint16 *) azBuf)[i] = qBound(0,qRound(a*100.0f),65535);
+		((qint16 *) elBuf)[i] = qBound(-32767,qRound(e*100.0f),32767);
+	}
+	else{
+		((float *) azBuf)[i] = a;
+		((float *) elBuf)[i] = e;
+	}
+}
+
+void TrackStore::dropOldest(int slot)
+{
+	records[slot].first++;
+	records[slot].count--;
+	records[slot].dropped++;
+}
+
+// The track spans too long for the ticks, so the oldest points are dropped until
+// time t can be represented, and the base is moved up to the oldest point left
+
+void TrackStore::rebase(int slot,int t)
+{
+	TrackSlot &s = records[slot];
+	while (s.count > 0 && (t - time(slot,0))/TRACK_TIME_UNIT > TRACK_MAX_TICKS)
+		dropOldest(slot);
+	if (s.count == 0){
+		s.t0=t;
+		return;
+	}
+	quint16 *ticks = tBuf + slot*stride + s.first;
+	int shift = ticks[0];
+	for (int i=0;i<s.count;i++)
+		ticks[i] -= shift;
+	s.t0 += shift*TRACK_TIME_UNIT;
+}
+
+void TrackStore::layout()
+{
+	header = (TrackHeader *) base;
+	records = (TrackSlot *) (base + sizeof(TrackHeader));
+	azBuf = (char *) (records + nSlots);
+	elBuf = azBuf + (size_t) nSlots*stride*coordSize;
+	tBuf  = (quint16 *) (elBuf + (size_t) nSlots*stride*coordSize);
+}
+
+// After growing, moves the arrays up to their new places, highest first.
+// The new places are all higher, so nothing is overwritten before it is moved.
+
+void TrackStore::moveArrays(int oldSlots,int newSlots)
+{
+	size_t oldArray = (size_t) oldSlots*stride*coordSize;
+	size_t newArray = (size_t) newSlots*stride*coordSize;
+	char *oldAz = base + sizeof(TrackHeader) + oldSlots*sizeof(TrackSlot);
+	char *newAz = base + sizeof(TrackHeader) + newSlots*sizeof(TrackSlot);
+	memmove(newAz + 2*newArray,oldAz + 2*oldArray,(size_t) oldSlots*stride*sizeof(quint16));
+	memmove(newAz + newArray,oldAz + oldArray,oldArray);
+	memmove(newAz,oldAz,oldArray);
+}
+
+// The sequence number is odd while the slot is being changed.
+// The fences keep the compiler from moving the changes outside the bracket.
+
+void TrackStore::beginChange(int slot)
+{
+	records[slot].seq++;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+void TrackStore::endChange(int slot)
+{
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+	records[slot].seq++;
+}
+
+size_t TrackStore::storeSize(int n) const
+{
+	return sizeof(TrackHeader) + (size_t) n*sizeof(TrackSlot) + (size_t) n*stride*bytesPerPoint();
+}
+
+quint16 TrackStore::headerChecksum() const
+{
+	TrackHeader h = *header;
+	h.valid=0;
+	h.checksum=0;
+	return qChecksum((const char *) &h,offsetof(TrackHeader,checksum));
+}
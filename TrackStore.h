@@ -0,0 +1,201 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __TRACK_STORE_H_
+#define __TRACK_STORE_H_
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+class QFile;
+
+#define TRACK_MAX_POINTS 4096 // default
+#define TRACK_MAX_AGE    0    // in seconds, 0 for no limit
+#define TRACK_ALIGNMENT  64   // bytes, a cache line
+#define TRACK_INIT_SLOTS 64
+#define TRACK_TIME_UNIT  2     // seconds per tick of the stored time
+#define TRACK_MAX_TICKS  65535 // so a track can span about 36 hours
+
+#define TRACK_FILE_MAGIC   "GVTRACKS"
+#define TRACK_FILE_VERSION 3
+
+// The layout of the store, in memory and on disk, is
+//   header
+//   slot records, one per slot
+//   azimuth, elevation and time arrays, each of nSlots*stride
+// Azimuth and elevation are floats or, more compactly, 16 bit centidegrees.
+// Time is stored as 16 bit ticks since the slot's base time.
+// So a point is 10 bytes, or 6 in centidegrees. The vertices drawn (TrackGeometry) are floats
+// either way, so counting them a point is 18 bytes, or 14, with no smoothing or a moving average.
+// Everything is in native byte order: the file is a cache, not an interchange format.
+
+struct TrackHeader // 64 bytes
+{
+	char    magic[8];
+	quint32 version;
+	quint32 valid;     // cleared while the layout is being changed
+	qint32  maxPoints;
+	qint32  stride;
+	qint32  nSlots;
+	qint32  timeUnit;
+	qint32  encoding;
+	quint16 checksum;  // of the preceding fields, excluding 'valid'
+	quint16 reserved;
+	char    padding[24];
+};
+
+struct TrackSlot // 32 bytes
+{
+	quint32 seq;       // odd while the slot is being changed
+	qint32  inUse;
+	qint16  constellation;
+	qint16  PRN;
+	qint32  t0;        // base time (UNIX) of the slot's time ticks
+	qint32  first;
+	qint32  count;
+	qint32  dropped;   // oldest points removed, since allocation
+	float   sn;
+};
+
+// Track history for all satellites, as a structure of arrays.
+// Azimuth, elevation and time are each one contiguous, aligned array. Every satellite 
+// has a slot, a fixed index range, in which its points are kept oldest first 
+// and contiguous, so that they can be scanned linearly.
+// A slot is twice the maximum number of points: new points are appended until the 
+// end of the slot is reached and then the retained points are moved back to the start,
+// so the cost per point is constant.
+// The history is capped at a number of points and, optionally, by age.
+// Times are non-decreasing, so the points up to a given time are found by binary search.
+//
+// The store can be kept in a memory-mapped file, so that it survives a restart or a crash.
+// Each slot has a sequence number which is odd while the slot is being changed, 
+// so a slot caught mid-change by a crash is discarded when the file is opened again.
+// The ordering only holds against the process dying: the fences are compiler barriers and
+// nothing is synced, so after a power loss the file may be inconsistent in ways that aren't detected.
+// The file is locked while it is open, so that only one process maps it.
+
+class TrackStore
+{
+	public:
+	
+		enum Encoding {Float=0,Centidegrees=1};
+		
+		TrackStore();
+		~TrackStore();
+		
+		void setLimits(int,int); // before any slots are allocated
+		void setEncoding(int); // ditto
+		bool open(const QString &); // ditto; fails if another process has the file open
+		void close();
+		
+		int  allocate();
+		void release(int);
+		int  duplicate(int);
+		void append(int,float,float,int);
+		void replaceLast(int,float,float,int);
+		void setIdentity(int,int,int);
+		void setSignal(int,float);
+		
+		QList<int> takeRestored(); // slots recovered from the file, to be claimed or released
+		
+		int size(int slot) const {return records[slot].count;}
+		int dropped(int slot) const {return records[slot].dropped;}
+		int constellation(int slot) const {return records[slot].constellation;}
+		int PRN(int slot) const {return records[slot].PRN;}
+		float signal(int slot) const {return records[slot].sn;}
+		float az(int slot,int i) const 
+			{return encoding == Centidegrees ? 0.01f*((const quint16 *) azBuf)[index(slot,i)] : ((const float *) azBuf)[index(slot,i)];}
+		float elev(int slot,int i) const 
+			{return encoding == Centidegrees ? 0.01f*((const qint16 *) elBuf)[index(slot,i)] : ((const float *) elBuf)[index(slot,i)];}
+		int time(int slot,int i) const {return records[slot].t0 + TRACK_TIME_UNIT*tBuf[slot*stride + records[slot].first + i];}
+		int pointsAt(int,int) const;
+		
+		int maxPoints() const {return limitPoints;}
+		int bytesPerPoint() const {return 2*coordSize + sizeof(quint16);}
+		int slotsInUse() const {return nSlots - freeSlots.size();}
+		int slotsFree() const {return freeSlots.size();}
+		int slotsHighWater() const {return maxInUse;}
+		int slotCount() const {return nSlots;}
+		
+	private:
+	
+		size_t index(int slot,int i) const {return (size_t) slot*stride + records[slot].first + i;}
+		void  setCoords(size_t,float,float);
+		
+		void grow();
+		bool restore();
+		void layout();
+		void moveArrays(int,int);
+		void dropOldest(int);
+		void rebase(int,int);
+		void beginChange(int);
+		void endChange(int);
+		size_t storeSize(int) const;
+		quint16 headerChecksum() const;
+		
+		char  *base; // all of the store
+		QFile *file; // if it's mapped
+		TrackHeader *header;
+		TrackSlot *records;
+		char    *azBuf,*elBuf; // encoded
+		quint16 *tBuf;
+		int encoding,coordSize;
+		int stride; // floats per slot
+		int nSlots;
+		QList<int> freeSlots;
+		QList<int> restored;
+		
+		int limitPoints,limitAge;
+		int maxInUse;
+};
+
+// A satellite's handle on its slot in the store
+
+class Track
+{
+	public:
+	
+		Track(){store=NULL;slot=-1;}
+		
+		void  append(float a,float e,int t){store->append(slot,a,e,t);}
+		void  replaceLast(float a,float e,int t){store->replaceLast(slot,a,e,t);}
+		void  setSignal(float s){store->setSignal(slot,s);}
+		int   size() const {return store->size(slot);}
+		bool  isEmpty() const {return store->size(slot)==0;}
+		float az(int i) const {return store->az(slot,i);} // oldest first
+		float elev(int i) const {return store->elev(slot,i);}
+		float lastAz() const {return store->az(slot,size()-1);}
+		float lastElev() const {return store->elev(slot,size()-1);}
+		int   dropped() const {return store->dropped(slot);}
+		int   time(int i) const {return store->time(slot,i);}
+		int   lastTime() const {return store->time(slot,size()-1);}
+		int   pointsAt(int t) const {return store->pointsAt(slot,t);} // the number of points at or before time t
+		
+		TrackStore *store;
+		int slot;
+};
+
+#endif
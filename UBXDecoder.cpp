@@ -0,0 +1,168 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <time.h>
+
+#include <QDebug>
+
+#include "GNSSSV.h"
+#include "UBXDecoder.h"
+
+#define UBX_SYNC1       0xb5
+#define UBX_SYNC2       0x62
+#define UBX_HEADER_SIZE 6    // sync (2) | class (1) | ID (1) | length (2)
+#define UBX_MAX_PAYLOAD 8192 // anything longer is taken to be a false sync
+#define UBX_CLASS_NAV   0x01
+#define UBX_ID_NAV_SAT  0x35
+
+static inline unsigned int getU16(const char *p)
+{
+	return (unsigned char) p[0] | ((unsigned char) p[1] << 8);
+}
+
+static inline int getS16(const char *p)
+{
+	return (short) getU16(p);
+}
+
+UBXDecoder::UBXDecoder(QList<ConstellationProperties *> &c,ObservationRing *r):StreamDecoder(c,r)
+{
+}
+
+void UBXDecoder::decode(const char *buf,int len)
+{
+	pending.append(buf,len);
+	
+	const char *p = pending.constData();
+	int n = pending.size();
+	int i=0;
+	
+	while (n-i >= UBX_HEADER_SIZE){
+		if (!((unsigned char) p[i] == UBX_SYNC1 && (unsigned char) p[i+1] == UBX_SYNC2)){
+			i++;
+			nSkipped++;
+			continue;
+		}
+		int length = getU16(p+i+4); // payload only
+		if (length > UBX_MAX_PAYLOAD){
+			i++;
+			nSkipped++;
+			continue;
+		}
+		if (n-i < UBX_HEADER_SIZE + length + 2) break; // wait for the rest of it
+		
+		unsigned char ckA,ckB;
+		checksum(p+i+2,length+4,&ckA,&ckB);
+		const char *ck = p+i+UBX_HEADER_SIZE+length;
+		if ((unsigned char) ck[0] != ckA || (unsigned char) ck[1] != ckB){
+			i++; // might have been a spurious sync so resync from the next byte
+			nBadMessages++;
+			continue;
+		}
+		
+		nMessages++;
+		decodeMessage((unsigned char) p[i+2],(unsigned char) p[i+3],p+i+UBX_HEADER_SIZE,length);
+		i += UBX_HEADER_SIZE + length + 2;
+	}
+	
+	pending.remove(0,i);
+}
+
+// 8-bit Fletcher checksum, computed over the class, ID, length and payload
+
+void UBXDecoder::checksum(const char *buf,int len,unsigned char *ckA,unsigned char *ckB)
+{
+	unsigned char a=0,b=0;
+	for (int i=0;i<len;i++){
+		a += (unsigned char) buf[i];
+		b += a;
+	}
+	*ckA=a;
+	*ckB=b;
+}
+
+// Maps a UBX gnssId and svId to constellation and PRN
+
+bool UBXDecoder::UBXtoGNSSParams(int gnssId,int svId,int *constellation,int *prn)
+{
+	*constellation=-1;
+	*prn=svId;
+	
+	switch (gnssId){
+		case 0: *constellation=GNSSSV::GPS; break;
+		case 1: *constellation=GNSSSV::SBAS; *prn=svId-100; break; // svId is 120-158
+		case 2: *constellation=GNSSSV::Galileo; break;
+		case 3: *constellation=GNSSSV::Beidou; break;
+		case 5: *constellation=GNSSSV::QZSS; break;
+		case 6: *constellation=GNSSSV::GLONASS; break;
+	}
+	
+	return (*constellation != -1);
+}
+
+//
+// Private
+//
+
+void UBXDecoder::decodeMessage(int msgClass,int msgID,const char *payload,int length)
+{
+	if (msgClass == UBX_CLASS_NAV && msgID == UBX_ID_NAV_SAT)
+		decodeNavSat(payload,length);
+}
+
+void UBXDecoder::decodeNavSat(const char *d,int len)
+{
+	// iTOW (4) | version (1) | numSvs (1) | reserved (2)
+	if (len < 8) return;
+	int numSvs = (unsigned char) d[5];
+	if (len < 8 + 12*numSvs) return;
+	
+	int t = time(NULL); // as for SBF
+	int nobs=0;
+	for (int s=0;s<numSvs;s++){
+		// gnssId (1) | svId (1) | cno (1) | elev (1) | azim (2) | prRes (2) | flags (4)
+		const char *b = d + 8 + 12*s;
+		int gnssId = (unsigned char) b[0];
+		int svId = (unsigned char) b[1];
+		int cno = (unsigned char) b[2];
+		int elev = (signed char) b[3];
+		int azim = getS16(b+4);
+		int orbitSource = ((unsigned char) b[9]) & 0x07; // flags bits 8-10
+		if (orbitSource == 0 || elev < -90 || elev > 90) continue; // position unknown
+		
+		int constellation,prn;
+		if (!UBXtoGNSSParams(gnssId,svId,&constellation,&prn)) continue;
+		if (!validate(constellation,prn)) continue;
+		Observation &o = epoch[nobs++];
+		o.timestamp=t;
+		o.constellation=constellation;
+		o.PRN=prn;
+		o.az=azim;
+		o.elev=elev;
+		o.sn=cno;
+	}
+	if (nobs > 0)
+		publish(epoch,nobs);
+}
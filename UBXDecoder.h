@@ -0,0 +1,61 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __UBX_DECODER_H_
+#define __UBX_DECODER_H_
+
+#include <QByteArray>
+
+#include "Observation.h"
+#include "StreamDecoder.h"
+
+#define UBX_MAX_SVS 255
+
+// Decodes u-blox UBX.
+// Each NAV-SAT (0x01 0x35) message has azimuth, elevation and C/N0 for every 
+// satellite in view and is published as one epoch.
+
+class UBXDecoder : public StreamDecoder
+{
+	public:
+	
+		UBXDecoder(QList<ConstellationProperties *> &,ObservationRing *);
+		
+		virtual void decode(const char *,int);
+		virtual QString name(){return "UBX";}
+		
+		static void checksum(const char *,int,unsigned char *,unsigned char *);
+		static bool UBXtoGNSSParams(int,int,int *,int *);
+		
+	private:
+	
+		void decodeMessage(int,int,const char *,int);
+		void decodeNavSat(const char *,int);
+		
+		QByteArray pending;
+		Observation epoch[UBX_MAX_SVS];
+};
+
+#endif
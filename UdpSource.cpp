@@ -0,0 +1,173 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <string.h>
+
+#include <QDebug>
+#include <QHostAddress>
+#include <QNetworkInterface>
+#include <QUdpSocket>
+
+#include <sys/types.h> // flimflummery
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "UdpSource.h"
+#ifdef Q_OS_LINUX
+#include "MulticastReceiver.h"
+#endif
+
+UdpSource::UdpSource(QString addr,int p,QString i,QString b,StreamDecoder *d,QObject *parent):
+	InputSource(QString("udp:%1:%2").arg(addr).arg(p),d,parent)
+{
+	address=addr;
+	port=p;
+	iface=i;
+	backend=b;
+	udpSocket=NULL;
+	mcastReceiver=NULL;
+}
+
+bool UdpSource::open()
+{
+	unsigned int ifaddr = interfaceAddress(iface);
+	
+	if (backend == "recvmmsg"){
+#ifdef Q_OS_LINUX
+		mcastReceiver = new MulticastReceiver(this);
+		if (mcastReceiver->open(address,port,ifaddr)){
+			connect(mcastReceiver, SIGNAL(readyRead()),this, SLOT(readBatchedDatagrams()));
+			return true;
+		}
+		qWarning() << "Failed to open the recvmmsg receiver - falling back to QUdpSocket";
+		delete mcastReceiver;
+		mcastReceiver=NULL;
+#else
+		qWarning() << "recvmmsg is only available on Linux - using QUdpSocket";
+#endif
+	}
+	
+	udpSocket = new QUdpSocket(this);
+	if (!udpSocket->bind(port,QUdpSocket::ShareAddress)){
+		qWarning() << "Can't bind to port " << port;
+		return false;
+	}
+	
+	// Start of flimflummery
+	// Newer versions of Qt support this but for the moment we'll do it the Unix way 
+	int socketfd = udpSocket->socketDescriptor();
+	if (socketfd != -1){
+		ip_mreq mreq;
+		memset(&mreq,0,sizeof(ip_mreq));
+		mreq.imr_multiaddr.s_addr = inet_addr(address.toStdString().c_str()); // group addr
+		mreq.imr_interface.s_addr = ifaddr;
+
+		//Make this a member of the Multicast Group
+		if(setsockopt(socketfd, IPPROTO_IP, IP_ADD_MEMBERSHIP, (const void *)&mreq,sizeof(mreq)) < 0){
+			qDebug("Failed to add to multicast group");
+		}
+		
+		// set TTL (Time To Live)
+		unsigned int ttl = 38; // restricted to 38 hops
+		if (setsockopt(socketfd, IPPROTO_IP, IP_MULTICAST_TTL, (const char *)&ttl, sizeof(ttl) ) < 0){
+			qDebug("Failed to set TTL");
+		}
+	}
+	else{
+		qDebug() << "Bad socket fd!";
+	}
+	// End of flimflummery
+	
+	connect(udpSocket, SIGNAL(readyRead()),this, SLOT(readPendingDatagrams()));
+	return true;
+}
+
+void UdpSource::logStatistics()
+{
+#ifdef Q_OS_LINUX
+	if (mcastReceiver) mcastReceiver->logStatistics();
+#endif
+	InputSource::logStatistics();
+}
+
+// Returns the IPv4 address (in network order) of an interface given by name (eg eth0) or address.
+// An empty or unknown interface gives INADDR_ANY, ie the default.
+
+unsigned int UdpSource::interfaceAddress(QString i)
+{
+	if (i.isEmpty()) return htonl(INADDR_ANY);
+	
+	QHostAddress ha;
+	if (ha.setAddress(i) && ha.protocol() == QAbstractSocket::IPv4Protocol)
+		return htonl(ha.toIPv4Address());
+	
+	QNetworkInterface ni = QNetworkInterface::interfaceFromName(i);
+	QList<QNetworkAddressEntry> entries = ni.addressEntries();
+	for (int e=0;e<entries.size();e++){
+		if (entries.at(e).ip().protocol() == QAbstractSocket::IPv4Protocol)
+			return htonl(entries.at(e).ip().toIPv4Address());
+	}
+	qWarning() << "No IPv4 address for interface " << i << " - using the default";
+	return htonl(INADDR_ANY);
+}
+
+//
+// Private slots
+//
+
+void UdpSource::readPendingDatagrams()
+{
+	while (udpSocket->hasPendingDatagrams()) {
+		datagram.resize(udpSocket->pendingDatagramSize()); // reuses the buffer's allocation
+		QHostAddress sender;
+		quint16 senderPort;
+
+		qint64 n = udpSocket->readDatagram(datagram.data(), datagram.size(),&sender, &senderPort);
+		if (n < 0){
+			nErrors++;
+			continue;
+		}
+		//qDebug() << datagram.data();
+		
+		receivedDatagram(datagram.constData(),n);
+	}
+}
+
+void UdpSource::readBatchedDatagrams()
+{
+#ifdef Q_OS_LINUX
+	int n;
+	while ((n = mcastReceiver->receive()) > 0){
+		for (int i=0;i<n;i++){
+			int len;
+			const char *buf = mcastReceiver->datagram(i,&len);
+			if (buf)
+				receivedDatagram(buf,len);
+		}
+		if (n < RECV_BATCH_SIZE) break; // socket is drained
+	}
+#endif
+}
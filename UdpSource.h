@@ -0,0 +1,70 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __UDP_SOURCE_H_
+#define __UDP_SOURCE_H_
+
+#include <QByteArray>
+
+#include "InputSource.h"
+
+class QUdpSocket;
+
+class MulticastReceiver;
+
+// Receives multicast UDP, with either QUdpSocket or, on Linux, recvmmsg().
+// The multicast group is joined on the given interface, or the default one.
+
+class UdpSource : public InputSource
+{
+	Q_OBJECT
+	
+	public:
+	
+		UdpSource(QString,int,QString,QString,StreamDecoder *,QObject *parent=0);
+		
+		virtual bool open();
+		virtual void logStatistics();
+		
+		static unsigned int interfaceAddress(QString);
+		
+	private slots:
+	
+		void readPendingDatagrams();
+		void readBatchedDatagrams();
+		
+	private:
+	
+		QString address;
+		int     port;
+		QString iface;
+		QString backend;
+		
+		QUdpSocket *udpSocket;
+		MulticastReceiver *mcastReceiver;
+		QByteArray datagram;
+};
+
+#endif
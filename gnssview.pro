@@ -1,23 +1,68 @@
 HEADERS       = ConstellationProperties.h \
-								GLText.h \
+								DatagramDecoder.h \
+								DatagramParser.h \
+								DeviceSource.h \
+								EpochStager.h \
+								ExpiryWheel.h \
+								FileTailSource.h \
+								GlyphAtlas.h \
 								GNSSView.h \
 								GNSSViewWidget.h \
 								GNSSViewApp.h \
+								Ingestor.h \
+								InputSource.h \
+								NMEADecoder.h \
 								GNSSSV.h \
+								Observation.h \
+								ObservationRing.h \
 								Sun.h \
 								Colour.h \
 								PowerManager.h \
-								SkyModel.h
+								SatelliteTable.h \
+								SBFDecoder.h \
+								StreamDecoder.h \
+								TrackArchive.h \
+								TrackBuffer.h \
+								TrackGeometry.h \
+								TrackStore.h \
+								TcpSource.h \
+								UBXDecoder.h \
+								UdpSource.h \
+								SkyModel.h \
+								SlabPool.h \
+								SpriteBatch.h
 SOURCES       = ConstellationProperties.cpp \
-								GLText.cpp \
+								DatagramDecoder.cpp \
+								DatagramParser.cpp \
+								DeviceSource.cpp \
+								EpochStager.cpp \
+								ExpiryWheel.cpp \
+								FileTailSource.cpp \
+								GlyphAtlas.cpp \
 								GNSSView.cpp \
 								GNSSViewWidget.cpp \
 								GNSSViewApp.cpp \
+								Ingestor.cpp \
+								InputSource.cpp \
+								NMEADecoder.cpp \
+								ObservationRing.cpp \
 								GNSSSV.cpp \
 								Sun.cpp \
 								Colour.cpp \
 								PowerManager.cpp \
+								SatelliteTable.cpp \
+								SBFDecoder.cpp \
+								StreamDecoder.cpp \
+								TrackArchive.cpp \
+								TrackBuffer.cpp \
+								TrackGeometry.cpp \
+								TrackStore.cpp \
+								TcpSource.cpp \
+								UBXDecoder.cpp \
+								UdpSource.cpp \
 								SkyModel.cpp \
+								SlabPool.cpp \
+								SpriteBatch.cpp \
                 Main.cpp
 QT           += core gui network opengl xml
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
@@ -25,3 +70,8 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 CONFIG       += 
 DEFINES    += QT_NO_DEBUG_OUTPUT
 LIBS	       += -lGLU
+
+linux {
+	HEADERS += MulticastReceiver.h
+	SOURCES += MulticastReceiver.cpp
+}
@@ -0,0 +1,141 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdlib.h>
+#include <cmath>
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include "Bench.h"
+#include "ConstellationProperties.h"
+#include "GNSSSV.h"
+
+QList<ConstellationProperties *> benchConstellations()
+{
+	QList<ConstellationProperties *> constellations;
+	for (int c = GNSSSV::Beidou;c<= GNSSSV::SBAS;c++){
+		constellations.append(new ConstellationProperties(c));
+		constellations.last()->setActive(true);
+	}
+	return constellations;
+}
+
+QList<QByteArray> loadCapture(QString fname)
+{
+	QList<QByteArray> datagrams;
+	QFile f(fname);
+	if (!f.open(QIODevice::ReadOnly)){
+		std::cerr << "Can't open " << fname.toStdString() << std::endl;
+		return datagrams;
+	}
+	
+	QByteArray dg,lastts;
+	while (!f.atEnd()){
+		QByteArray line = f.readLine();
+		if (line.trimmed().isEmpty()) continue;
+		QByteArray ts = line.left(line.indexOf(','));
+		if (ts != lastts && !dg.isEmpty()){
+			datagrams.append(dg);
+			dg.clear();
+		}
+		lastts=ts;
+		dg.append(line);
+	}
+	if (!dg.isEmpty())
+		datagrams.append(dg);
+	f.close();
+	return datagrams;
+}
+
+QList<QByteArray> syntheticCapture(int nsats,int nepochs)
+{
+	// Looks like the output of sbfsim.pl
+	QList<ConstellationProperties *> constellations = benchConstellations();
+	QList<QByteArray> datagrams;
+	int t0=1500000000;
+	for (int e=0;e<nepochs;e++){
+		QByteArray dg;
+		for (int s=0;s<nsats;s++){
+			int c = s % (GNSSSV::SBAS+1);
+			ConstellationProperties *cprop = constellations.at(c);
+			int prn = cprop->svIDmin + (s/(GNSSSV::SBAS+1)) % (cprop->svIDmax-cprop->svIDmin+1);
+			double az = fmod(s*37.0 + e*0.01,360.0);
+			double el = 5.0 + fmod(s*11.0 + e*0.005,85.0);
+			dg.append(QString("%1,%2,%3,%4,%5,%6\n").arg(t0+e/10).arg(c).arg(prn)
+				.arg(az,0,'f',2).arg(el,0,'f',2).arg(30+s%25).toLatin1());
+		}
+		datagrams.append(dg);
+	}
+	qDeleteAll(constellations);
+	return datagrams;
+}
+
+void reportTiming(const char *what,double ns,long n,const char *units)
+{
+	std::cout << "  " << what << ": " << ns/n << " ns/" << units << std::endl;
+}
+
+static void usage()
+{
+	std::cout << "Usage: gnssbench <benchmark> [options]" << std::endl;
+	std::cout << std::endl;
+	std::cout << "parse [capture_file]   CSV datagram parsing, QString vs in place" << std::endl;
+	std::cout << "wire  [capture_file]   CSV vs binary datagrams, size and parse time" << std::endl;
+	std::cout << "nmea  [nmea_log]       NMEA decoder throughput" << std::endl;
+	std::cout << "track [--nosmooth]     track vertex generation, QList vs TrackStore" << std::endl;
+	std::cout << "decode                 track point decoding, QList vs TrackStore encodings" << std::endl;
+}
+
+int main(int argc,char **argv)
+{
+	QCoreApplication a(argc,argv);
+	QStringList args = a.arguments();
+	
+	if (args.size() < 2 || args.at(1) == "--help"){
+		usage();
+		return EXIT_SUCCESS;
+	}
+	
+	QString bench = args.at(1);
+	args = args.mid(2);
+	
+	if (bench == "parse")
+		return parserBench(args);
+	else if (bench == "wire")
+		return wireBench(args);
+	else if (bench == "nmea")
+		return nmeaBench(args);
+	else if (bench == "track")
+		return trackBench(args);
+	else if (bench == "decode")
+		return decodeBench(args);
+	
+	std::cout << "gnssbench: unknown benchmark '" << bench.toStdString() << "'" << std::endl;
+	usage();
+	return EXIT_FAILURE;
+}
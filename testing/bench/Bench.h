@@ -0,0 +1,56 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class ConstellationProperties;
+
+// Shared helpers for the benchmarks
+
+extern QList<ConstellationProperties *> benchConstellations(); // all active
+
+// Captured traffic is a file of CSV lines, as received by gnssview.
+// Consecutive lines with the same timestamp are grouped into one datagram.
+// If no file is given, a synthetic capture is generated
+extern QList<QByteArray> loadCapture(QString);
+extern QList<QByteArray> syntheticCapture(int nsats,int nepochs);
+
+extern void reportTiming(const char *,double,long,const char *);
+
+// The benchmarks
+
+extern int parserBench(QStringList &);
+extern int wireBench(QStringList &);
+extern int nmeaBench(QStringList &);
+extern int trackBench(QStringList &);
+extern int decodeBench(QStringList &);
+
+#endif
@@ -0,0 +1,145 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Decoding track points into a float vertex buffer, as when the geometry is rebuilt,
+// from the old per-satellite QList<double> storage and from the TrackStore encodings
+
+#include <cmath>
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+
+#include "Bench.h"
+#include "TrackStore.h"
+
+#define NSATS   100
+#define NPOINTS 4096
+#define REPEATS 20
+
+static double sink=0.0; // so that the work isn't optimised away
+
+static double legacyDecode(QList<QList<double> *> &az,QList<QList<double> *> &el,float *v)
+{
+	QElapsedTimer timer;
+	timer.start();
+	for (int r=0;r<REPEATS;r++){
+		for (int s=0;s<az.size();s++){
+			const QList<double> &a = *az.at(s);
+			const QList<double> &e = *el.at(s);
+			for (int j=0;j<a.size();j++){
+				v[2*j]=a.at(j);
+				v[2*j+1]=e.at(j);
+			}
+			sink += v[s];
+		}
+	}
+	return timer.nsecsElapsed();
+}
+
+static double storeDecode(QList<Track> &tracks,float *v)
+{
+	QElapsedTimer timer;
+	timer.start();
+	for (int r=0;r<REPEATS;r++){
+		for (int s=0;s<tracks.size();s++){
+			const Track &t = tracks.at(s);
+			int n = t.size();
+			for (int j=0;j<n;j++){
+				v[2*j]=t.az(j);
+				v[2*j+1]=t.elev(j);
+			}
+			sink += v[s];
+		}
+	}
+	return timer.nsecsElapsed();
+}
+
+int decodeBench(QStringList &)
+{
+	QList<QList<double> *> laz,lel;
+	TrackStore fstore,cstore;
+	fstore.setLimits(NPOINTS,0);
+	cstore.setLimits(NPOINTS,0);
+	cstore.setEncoding(TrackStore::Centidegrees);
+	QList<Track> ftracks,ctracks;
+	
+	for (int s=0;s<NSATS;s++){
+		laz.append(new QList<double>);
+		lel.append(new QList<double>);
+		Track ft,ct;
+		ft.store=&fstore;
+		ft.slot=fstore.allocate();
+		ct.store=&cstore;
+		ct.slot=cstore.allocate();
+		double az0 = fmod(s*37.0,360.0);
+		for (int j=0;j<NPOINTS;j++){
+			double az = fmod(az0 + j*0.05,360.0);
+			double el = 5.0 + 80.0*sin(M_PI*j/NPOINTS);
+			az = floor(az*100.0+0.5)/100.0; // as reported
+			el = floor(el*100.0+0.5)/100.0;
+			laz.last()->append(az);
+			lel.last()->append(el);
+			ft.append(az,el,j);
+			ct.append(az,el,j);
+		}
+		ftracks.append(ft);
+		ctracks.append(ct);
+	}
+	
+	float *v = new float[2*NPOINTS];
+	long npts = (long) REPEATS*NSATS*NPOINTS;
+	double tLegacy = legacyDecode(laz,lel,v);
+	double tFloat = storeDecode(ftracks,v);
+	double tCenti = storeDecode(ctracks,v);
+	
+	// the QList stores each double inline, in an array of pointer-sized entries
+	int legacyBytes = 2*qMax(sizeof(double),sizeof(void *));
+	
+	std::cout << NSATS << " satellites, " << NPOINTS << " points each" << std::endl;
+	reportTiming("QList<double>          ",tLegacy,npts,"point");
+	reportTiming("TrackStore, float       ",tFloat,npts,"point");
+	reportTiming("TrackStore, centidegrees",tCenti,npts,"point");
+	std::cout << "  bytes/point: QList<double> " << legacyBytes << " (no time), float " << fstore.bytesPerPoint() 
+		<< ", centidegrees " << cstore.bytesPerPoint() << std::endl;
+	std::cout << "  (TrackStore slots reserve twice the points kept)" << std::endl;
+	// the geometry drawn is floats whatever the encoding, a vertex per point unless it's subdivided
+	int geometryBytes = 2*sizeof(float);
+	std::cout << "  with the geometry drawn, bytes/point: float " << fstore.bytesPerPoint() + geometryBytes 
+		<< ", centidegrees " << cstore.bytesPerPoint() + geometryBytes << " (more with catmullrom)" << std::endl;
+	
+	double maxErr=0.0;
+	for (int s=0;s<NSATS;s++)
+		for (int j=0;j<NPOINTS;j++)
+			maxErr = qMax(maxErr,fabs(ctracks.at(s).az(j) - laz.at(s)->at(j)));
+	std::cout << "  largest centidegree azimuth error: " << maxErr << std::endl;
+	
+	delete[] v;
+	qDeleteAll(laz);
+	qDeleteAll(lel);
+	if (sink == 42.0) std::cout << std::endl;
+	return 0;
+}
@@ -0,0 +1,132 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Throughput of the NMEA decoder over a recorded NMEA log
+
+#include <cmath>
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+
+#include "Bench.h"
+#include "ConstellationProperties.h"
+#include "NMEADecoder.h"
+#include "Observation.h"
+#include "ObservationRing.h"
+
+#define NREPEATS 20
+#define READ_SIZE 4096 // roughly what a read() from a serial port or pipe delivers
+
+static QByteArray sentence(const QByteArray &body)
+{
+	unsigned char sum=0;
+	for (int i=0;i<body.size();i++)
+		sum ^= (unsigned char) body.at(i);
+	return "$" + body + "*" + QByteArray::number(sum,16).rightJustified(2,'0').toUpper() + "\r\n";
+}
+
+// GSV groups for a few talkers, one group per talker per epoch, with RMC and GSA in between
+static QByteArray syntheticNMEA(int nepochs)
+{
+	const char *talkers[] = {"GP","GL","GA","GB"};
+	const int nsats[] = {12,8,9,11};
+	const int idOffset[] = {0,64,0,0};
+	
+	QByteArray log;
+	for (int e=0;e<nepochs;e++){
+		log.append(sentence("GPRMC,000000.00,A,3352.2000,S,15112.6000,E,0.0,0.0,010120,,,A"));
+		log.append(sentence("GNGSA,A,3,01,03,06,09,12,17,19,22,,,,,1.2,0.7,0.9"));
+		for (int t=0;t<4;t++){
+			int total = (nsats[t]+3)/4;
+			for (int n=0;n<total;n++){
+				QByteArray body = QByteArray(talkers[t]) + "GSV," + QByteArray::number(total) + "," + 
+					QByteArray::number(n+1) + "," + QByteArray::number(nsats[t]);
+				for (int s=4*n;s<nsats[t] && s < 4*n+4;s++){
+					int el = 5 + (s*11 + e/60) % 85;
+					int az = (s*37 + e/30) % 360;
+					body.append("," + QByteArray::number(idOffset[t]+s+1).rightJustified(2,'0') + "," + 
+						QByteArray::number(el) + "," + QByteArray::number(az).rightJustified(3,'0') + "," + QByteArray::number(30+s%20));
+				}
+				log.append(sentence(body));
+			}
+		}
+	}
+	return log;
+}
+
+int nmeaBench(QStringList &args)
+{
+	QByteArray log;
+	if (args.size() > 0){
+		QFile f(args.at(0));
+		if (!f.open(QIODevice::ReadOnly)){
+			std::cerr << "Can't open " << args.at(0).toStdString() << std::endl;
+			return 1;
+		}
+		log = f.readAll();
+		f.close();
+	}
+	else
+		log = syntheticNMEA(3600);
+	
+	if (log.isEmpty()){
+		std::cerr << "No data" << std::endl;
+		return 1;
+	}
+	
+	QList<ConstellationProperties *> constellations = benchConstellations();
+	ObservationRing ring(4096);
+	Observation obs[MAX_OBSERVATIONS];
+	NMEADecoder *decoder=NULL;
+	
+	QElapsedTimer timer;
+	double ns=0.0;
+	for (int r=0;r<NREPEATS;r++){
+		delete decoder;
+		decoder = new NMEADecoder(constellations,&ring);
+		timer.start();
+		for (int i=0;i<log.size();i+=READ_SIZE){
+			decoder->decode(log.constData()+i,(log.size()-i > READ_SIZE ? READ_SIZE : log.size()-i));
+			while (ring.pop(obs,MAX_OBSERVATIONS) > 0); // stand in for the GUI thread
+		}
+		ns += timer.nsecsElapsed();
+	}
+	
+	std::cout << "NMEA decoding (" << log.size() << " bytes, " << decoder->nMessages << " sentences, " 
+		<< decoder->nEpochs << " epochs, " << decoder->nObservations << " observations)" << std::endl;
+	std::cout << "  bad sentences=" << decoder->nBadMessages << " skipped bytes=" << decoder->nSkipped << std::endl;
+	reportTiming("decode",ns,(long) log.size()*NREPEATS,"byte");
+	reportTiming("decode",ns,(long) decoder->nMessages*NREPEATS,"sentence");
+	if (decoder->nEpochs > 0)
+		reportTiming("decode",ns,(long) decoder->nEpochs*NREPEATS,"epoch");
+	std::cout << "  throughput: " << (log.size()*NREPEATS)/(ns*1.0E-9)/1.0E6 << " MB/s" << std::endl;
+	std::cout << "  ring dropped=" << ring.dropped() << std::endl;
+	
+	delete decoder;
+	qDeleteAll(constellations);
+	return 0;
+}
@@ -0,0 +1,149 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares the original QString-based datagram parsing with DatagramParser
+
+#include <cmath>
+#include <iostream>
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "Bench.h"
+#include "ConstellationProperties.h"
+#include "DatagramParser.h"
+#include "GNSSSV.h"
+#include "Observation.h"
+
+#define MAXOBS 256
+#define NREPEATS 20
+
+// This is the parsing part of GNSSView::readPendingDatagrams() as it was
+static int legacyParse(const QByteArray &datagram,QList<ConstellationProperties *> &constellations,Observation *obs)
+{
+	int nobs=0;
+	QString str(datagram.data());
+	QStringList svd = str.split("\n");
+	for (int i=0;i<svd.size();i++){
+		QStringList sv = svd.at(i).split(",");
+		if (sv.size() == 6){
+			int c   = sv.at(1).toInt();
+			if (c<GNSSSV::Beidou || c > GNSSSV::SBAS) continue;
+			if (constellations.at(c)->isActive()){
+				int prn = sv.at(2).toInt();
+				ConstellationProperties *cprop = constellations.at(c);
+				if (prn < cprop->svIDmin || prn > cprop->svIDmax) continue;
+				if (nobs == MAXOBS) break;
+				Observation &o = obs[nobs++];
+				o.constellation=c;
+				o.PRN=prn;
+				o.az=sv.at(3).toDouble();
+				o.elev=sv.at(4).toDouble();
+				o.sn = sv.at(5).toDouble();
+				QDateTime u;
+				u.setTime_t(sv.at(0).toInt());
+				o.timestamp=u.toTime_t();
+			}
+		}
+	}
+	return nobs;
+}
+
+int parserBench(QStringList &args)
+{
+	QList<QByteArray> datagrams;
+	if (args.size() > 0)
+		datagrams = loadCapture(args.at(0));
+	else
+		datagrams = syntheticCapture(60,10000);
+	
+	if (datagrams.isEmpty()){
+		std::cerr << "No data" << std::endl;
+		return 1;
+	}
+	
+	long nbytes=0;
+	for (int i=0;i<datagrams.size();i++)
+		nbytes += datagrams.at(i).size();
+	
+	QList<ConstellationProperties *> constellations = benchConstellations();
+	DatagramParser parser(constellations);
+	Observation obs[MAXOBS];
+	
+	// Check that they agree before timing anything
+	long nlegacy=0,nnew=0,nmismatch=0;
+	Observation lobs[MAXOBS];
+	for (int i=0;i<datagrams.size();i++){
+		int nl = legacyParse(datagrams.at(i),constellations,lobs);
+		int nn = parser.parse(datagrams.at(i),obs,MAXOBS);
+		nlegacy += nl;
+		nnew += nn;
+		if (nl != nn){
+			nmismatch++;
+			continue;
+		}
+		for (int j=0;j<nn;j++){
+			if (lobs[j].PRN != obs[j].PRN || lobs[j].constellation != obs[j].constellation ||
+				lobs[j].timestamp != obs[j].timestamp ||
+				fabs(lobs[j].az - obs[j].az) > 1.0E-9 || fabs(lobs[j].elev - obs[j].elev) > 1.0E-9 ||
+				fabs(lobs[j].sn - obs[j].sn) > 1.0E-9){
+				nmismatch++;
+				break;
+			}
+		}
+	}
+	
+	std::cout << "datagrams: " << datagrams.size() << " bytes: " << nbytes << 
+		" observations: " << nlegacy << " (legacy) " << nnew << " (new)" << std::endl;
+	if (nmismatch)
+		std::cout << "WARNING: " << nmismatch << " datagrams parsed differently" << std::endl;
+		
+	QElapsedTimer timer;
+	long n=0;
+	
+	timer.start();
+	for (int r=0;r<NREPEATS;r++)
+		for (int i=0;i<datagrams.size();i++)
+			n += legacyParse(datagrams.at(i),constellations,obs);
+	double tlegacy = timer.nsecsElapsed();
+	
+	timer.restart();
+	for (int r=0;r<NREPEATS;r++)
+		for (int i=0;i<datagrams.size();i++)
+			n += parser.parse(datagrams.at(i),obs,MAXOBS);
+	double tnew = timer.nsecsElapsed();
+	
+	std::cout << "QString split/toDouble" << std::endl;
+	reportTiming("per observation",tlegacy,nlegacy*NREPEATS,"obs");
+	reportTiming("per datagram",tlegacy,(long) datagrams.size()*NREPEATS,"datagram");
+	std::cout << "DatagramParser" << std::endl;
+	reportTiming("per observation",tnew,nnew*NREPEATS,"obs");
+	reportTiming("per datagram",tnew,(long) datagrams.size()*NREPEATS,"datagram");
+	std::cout << "speedup: " << tlegacy/tnew << std::endl;
+	
+	qDeleteAll(constellations);
+	return (n > 0 ? 0 : 1);
+}
@@ -0,0 +1,213 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Track vertex generation (as in GNSSViewWidget::drawBirds) from the old per-satellite 
+// QList<double> storage and from the TrackStore
+
+#include <cmath>
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QStringList>
+
+#include "Bench.h"
+#include "TrackStore.h"
+
+#define NPOINTS 300 // about one pass, with points closer than 0.5 degrees dropped
+#define PHI0 100.0
+#define PHI1 313.0
+#define WORK 3000000 // points processed per timing, roughly
+
+class LegacySV
+{
+	public:
+		int constellation;
+		QList<double> az,elev;
+};
+
+class PackedSV
+{
+	public:
+		int constellation;
+		Track track;
+};
+
+static double sink=0.0; // so that the work isn't optimised away
+
+// Each vertex is x,y,alpha. The strips are counted, in lieu of glBegin()/glEnd()
+static int legacyVertices(QList<LegacySV *> &birds,float *v,int *nstrips,bool smooth)
+{
+	int nv=0;
+	for (int i=0;i<birds.size();++i){
+		int npts=birds.at(i)->az.size();
+		double deltaAlpha=0.9;
+		if (npts != 1)
+			deltaAlpha /= (npts-1.0);
+		int jdrop=npts;
+		bool dropping=true;
+		for (int j=npts-1;j>=0;j--){
+			double el;
+			double az =  birds.at(i)->az[j];
+			if (PHI1 > 360 &&  az+360 < PHI1)
+				az+=360.0;
+			if (!(az >=PHI0 && az<=PHI1)){
+				jdrop=j;
+				dropping=true;
+				continue;
+			}
+			if (dropping){
+				dropping=false;
+				(*nstrips)++;
+				v[nv++]=az; v[nv++]=birds.at(i)->elev[j]; v[nv++]=0.1+j*deltaAlpha;
+				continue;
+			}
+			el=birds.at(i)->elev[j];
+			if (smooth && j<= jdrop-3){
+				double az1 =  birds.at(i)->az[j+1];
+				if (PHI1 > 360 &&  az1+360 < PHI1)
+					az1+=360.0;
+				double az2 =  birds.at(i)->az[j+2];
+				if (PHI1 > 360 &&  az2+360 < PHI1)
+					az2+=360.0;
+				az= (az+az1+az2)/3.0;
+				el=(birds.at(i)->elev[j]+ birds.at(i)->elev[j+1]+ birds.at(i)->elev[j+2])/3.0;
+			}
+			v[nv++]=az; v[nv++]=el; v[nv++]=0.1+j*deltaAlpha;
+		}
+	}
+	return nv;
+}
+
+static int packedVertices(QList<PackedSV *> &birds,float *v,int *nstrips,bool smooth)
+{
+	int nv=0;
+	for (int i=0;i<birds.size();++i){
+		PackedSV *sv = birds.at(i);
+		const Track &t = sv->track;
+		int npts=sv->track.size();
+		float deltaAlpha=0.9;
+		if (npts != 1)
+			deltaAlpha /= (npts-1.0);
+		int jdrop=npts;
+		bool dropping=true;
+		for (int j=npts-1;j>=0;j--){
+			float el;
+			float az =  t.az(j);
+			if (PHI1 > 360 &&  az+360 < PHI1)
+				az+=360.0;
+			if (!(az >=PHI0 && az<=PHI1)){
+				jdrop=j;
+				dropping=true;
+				continue;
+			}
+			if (dropping){
+				dropping=false;
+				(*nstrips)++;
+				v[nv++]=az; v[nv++]=t.elev(j); v[nv++]=0.1+j*deltaAlpha;
+				continue;
+			}
+			el=t.elev(j);
+			if (smooth && j<= jdrop-3){
+				float az1 =  t.az(j+1);
+				if (PHI1 > 360 &&  az1+360 < PHI1)
+					az1+=360.0;
+				float az2 =  t.az(j+2);
+				if (PHI1 > 360 &&  az2+360 < PHI1)
+					az2+=360.0;
+				az= (az+az1+az2)/3.0;
+				el=(t.elev(j)+ t.elev(j+1)+ t.elev(j+2))/3.0;
+			}
+			v[nv++]=az; v[nv++]=el; v[nv++]=0.1+j*deltaAlpha;
+		}
+	}
+	return nv;
+}
+
+static void runSize(int nsats,bool smooth)
+{
+	QList<LegacySV *> legacy;
+	QList<PackedSV *> packed;
+	TrackStore store;
+	store.setLimits(NPOINTS,0);
+	
+	// Interleave the allocations, as satellites come and go, so that the legacy lists are scattered
+	for (int i=0;i<nsats;i++){
+		LegacySV *lsv = new LegacySV;
+		PackedSV *psv = new PackedSV;
+		lsv->constellation = psv->constellation = i % 6;
+		psv->track.store=&store;
+		psv->track.slot=store.allocate();
+		double az0 = fmod(i*37.0,360.0);
+		for (int j=0;j<NPOINTS;j++){
+			double az = fmod(az0 + j*0.5,360.0);
+			double el = 5.0 + 80.0*sin(M_PI*j/NPOINTS);
+			lsv->az.append(az);
+			lsv->elev.append(el);
+			psv->track.append(az,el,j);
+		}
+		legacy.append(lsv);
+		packed.append(psv);
+	}
+	
+	float *v = new float[3*nsats*NPOINTS];
+	int nrepeats = qMax(1,WORK/(nsats*NPOINTS));
+	long npts = (long) nrepeats*nsats*NPOINTS;
+	QElapsedTimer timer;
+	int nstrips=0,nv=0;
+	
+	timer.start();
+	for (int r=0;r<nrepeats;r++){
+		nv = legacyVertices(legacy,v,&nstrips,smooth);
+		sink += v[nv/2];
+	}
+	double tLegacy = timer.nsecsElapsed();
+	
+	timer.start();
+	for (int r=0;r<nrepeats;r++){
+		nv = packedVertices(packed,v,&nstrips,smooth);
+		sink += v[nv/2];
+	}
+	double tPacked = timer.nsecsElapsed();
+	
+	std::cout << nsats << " satellites, " << NPOINTS << " points each, " << nv/3 << " vertices" << std::endl;
+	reportTiming("QList<double>",tLegacy,npts,"point");
+	reportTiming("TrackStore   ",tPacked,npts,"point");
+	std::cout << "  speedup: " << tLegacy/tPacked << std::endl;
+	
+	delete[] v;
+	qDeleteAll(legacy);
+	qDeleteAll(packed);
+}
+
+int trackBench(QStringList &args)
+{
+	bool smooth = !args.contains("--nosmooth");
+	int sizes[] = {100,1000,10000};
+	for (int i=0;i<3;i++)
+		runSize(sizes[i],smooth);
+	if (sink == 42.0) std::cout << std::endl;
+	return 0;
+}
@@ -0,0 +1,143 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares the CSV and binary wire formats: bytes per observation and parse time
+
+#include <cmath>
+#include <iostream>
+
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "Bench.h"
+#include "ConstellationProperties.h"
+#include "DatagramParser.h"
+#include "Observation.h"
+
+#define MAXOBS 256
+#define NREPEATS 20
+
+static void putU16(QByteArray &b,unsigned int v)
+{
+	b.append((char) (v & 0xff));
+	b.append((char) ((v >> 8) & 0xff));
+}
+
+static void putU32(QByteArray &b,unsigned int v)
+{
+	putU16(b,v & 0xffff);
+	putU16(b,(v >> 16) & 0xffff);
+}
+
+// Encodes observations in the binary format. All observations are assumed to be for one epoch
+static QByteArray encodeBinary(Observation *obs,int nobs,unsigned int seq)
+{
+	QByteArray b;
+	b.append(BINARY_MAGIC0);
+	b.append(BINARY_MAGIC1);
+	b.append((char) BINARY_VERSION);
+	b.append((char) BINARY_RECORD_SIZE);
+	putU32(b,seq);
+	putU32(b,(nobs > 0 ? obs[0].timestamp : 0));
+	putU16(b,nobs);
+	putU16(b,0);
+	for (int i=0;i<nobs;i++){
+		b.append((char) obs[i].constellation);
+		b.append((char) obs[i].PRN);
+		putU16(b,((int) lrint(obs[i].az*100.0)) % 36000);
+		putU16(b,(unsigned int) ((int) lrint(obs[i].elev*100.0)) & 0xffff);
+		putU16(b,(unsigned int) lrint(obs[i].sn*100.0));
+	}
+	return b;
+}
+
+static double timeParse(DatagramParser &parser,QList<QByteArray> &datagrams,Observation *obs,long *n)
+{
+	QElapsedTimer timer;
+	timer.start();
+	for (int r=0;r<NREPEATS;r++){
+		for (int i=0;i<datagrams.size();i++){
+			const QByteArray &dg = datagrams.at(i);
+			int pos=0;
+			while (pos < dg.size())
+				*n += parser.parse(dg,obs,MAXOBS,&pos);
+		}
+	}
+	return timer.nsecsElapsed();
+}
+
+int wireBench(QStringList &args)
+{
+	QList<QByteArray> text;
+	if (args.size() > 0)
+		text = loadCapture(args.at(0));
+	else
+		text = syntheticCapture(60,10000);
+	
+	if (text.isEmpty()){
+		std::cerr << "No data" << std::endl;
+		return 1;
+	}
+	
+	QList<ConstellationProperties *> constellations = benchConstellations();
+	DatagramParser parser(constellations);
+	Observation obs[MAXOBS];
+	
+	// Convert the capture to binary, dropping anything that doesn't validate
+	// so that both formats carry the same observations
+	QList<QByteArray> binary;
+	long nobs=0,textBytes=0,binaryBytes=0;
+	for (int i=0;i<text.size();i++){
+		textBytes += text.at(i).size();
+		int pos=0;
+		while (pos < text.at(i).size()){
+			int n = parser.parse(text.at(i),obs,MAXOBS,&pos);
+			binary.append(encodeBinary(obs,n,binary.size()));
+			binaryBytes += binary.last().size();
+			nobs += n;
+		}
+	}
+	
+	if (nobs == 0){
+		std::cerr << "No valid observations" << std::endl;
+		return 1;
+	}
+	
+	long ntext=0,nbinary=0;
+	double ttext = timeParse(parser,text,obs,&ntext);
+	double tbinary = timeParse(parser,binary,obs,&nbinary);
+	
+	std::cout << "observations: " << nobs << std::endl;
+	std::cout << "CSV" << std::endl;
+	std::cout << "  bytes: " << textBytes << " (" << (double) textBytes/nobs << " bytes/obs)" << std::endl;
+	reportTiming("parse",ttext,ntext,"obs");
+	std::cout << "binary" << std::endl;
+	std::cout << "  bytes: " << binaryBytes << " (" << (double) binaryBytes/nobs << " bytes/obs)" << std::endl;
+	reportTiming("parse",tbinary,nbinary,"obs");
+	std::cout << "size ratio: " << (double) textBytes/binaryBytes << " speedup: " << (ttext/ntext)/(tbinary/nbinary) << std::endl;
+	
+	qDeleteAll(constellations);
+	return 0;
+}
@@ -0,0 +1,35 @@
+# Microbenchmarks for gnssview
+#
+#	qmake bench.pro
+#	make
+#	./gnssbench --help
+
+TEMPLATE      = app
+TARGET        = gnssbench
+INCLUDEPATH  += ../..
+HEADERS       = Bench.h \
+								../../ConstellationProperties.h \
+								../../DatagramParser.h \
+								../../NMEADecoder.h \
+								../../Observation.h \
+								../../ObservationRing.h \
+								../../StreamDecoder.h \
+								../../TrackStore.h
+SOURCES       = Bench.cpp \
+								DecodeBench.cpp \
+								ParserBench.cpp \
+								NMEABench.cpp \
+								TrackBench.cpp \
+								WireBench.cpp \
+								../../ConstellationProperties.cpp \
+								../../DatagramParser.cpp \
+								../../NMEADecoder.cpp \
+								../../ObservationRing.cpp \
+								../../StreamDecoder.cpp \
+								../../TrackStore.cpp
+QT           += core gui opengl
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG       += console
+CONFIG       -= app_bundle
+DEFINES      += QT_NO_DEBUG_OUTPUT
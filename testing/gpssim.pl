@@ -2,14 +2,21 @@
 
 # Simulates GNSS satellite systems using CCTF files as input
 # NB libio-socket-multicast-perl needed in Ubuntu
+# Usage: gpssim.pl [-b]
+#   -b  send binary datagrams instead of CSV
 use Time::HiRes qw(usleep);
 use IO::Socket::Multicast;
+use Getopt::Std;
 
 sub ReadGPSCCTF;
 sub UpdateSatellites;
 sub BroadcastData;
 sub Interpolate;
 
+our $opt_b;
+getopts('b');
+$seq=0;
+
 use constant DESTINATION => '226.1.1.37:14544'; 
 my $sock = IO::Socket::Multicast->new(Proto=>'udp',PeerAddr=>DESTINATION);
 $sock->mcast_ttl(10); # time to live
@@ -113,6 +120,18 @@ sub BroadcastData()
 {
 	my $i;
 	my $data="";
+	if ($opt_b){
+		# header: magic,version,record size,sequence number,timestamp,record count,reserved
+		$data = pack("a2CCVVvv","GV",1,8,$seq++,time(),$#birds+1,0);
+		for ($i=0;$i<=$#birds;$i++)
+		{
+			# centidegrees and hundredths
+			$data .= pack("CCvs<v",$birds[$i][1],$birds[$i][2],(int($birds[$i][3]*10)*100) % 36000,
+				int($birds[$i][4]*10)*100,int($birds[$i][5])*100);
+		}
+		$sock->send($data) || print "Couldn't send\n";
+		return;
+	}
 	for ($i=0;$i<=$#birds;$i++)
 	{
 		$data .= sprintf("$birds[$i][0],$birds[$i][1],$birds[$i][2],%d,%d,%d\n",$birds[$i][3]*10,$birds[$i][4]*10,$birds[$i][5]);
@@ -2,8 +2,14 @@
 
 # Simulates GNSS satellite systems using SBFfiles as input
 # NB libio-socket-multicast-perl needed in Ubuntu
+# Usage: sbfsim.pl [-b] sbf_file
+#   -b  send binary datagrams instead of CSV
 use Time::HiRes qw(usleep);
 use IO::Socket::Multicast;
+use Getopt::Std;
+
+getopts('b');
+$seq=0;
 
 
 use constant DESTINATION => '226.1.1.37:14544'; 
@@ -208,12 +214,24 @@ sub ParseSatVisibility
 sub BroadcastData
 {
 	my $bd="";
+	my $nrecs=0;
 	foreach my $key (keys %GNSS){
 		if (defined($GNSS{$key}[2]) && defined($GNSS{$key}[4])){
-			my $t = time();
-			$bd .= "$t,$GNSS{$key}[0],$GNSS{$key}[1],$GNSS{$key}[2],$GNSS{$key}[3],$GNSS{$key}[4]\n";
+			if ($opt_b){ # centidegrees and hundredths
+				$bd .= pack("CCvs<v",$GNSS{$key}[0],$GNSS{$key}[1],int($GNSS{$key}[2]*100+0.5) % 36000,
+					sprintf("%.0f",$GNSS{$key}[3]*100),int($GNSS{$key}[4]*100+0.5));
+				$nrecs++;
+			}
+			else{
+				my $t = time();
+				$bd .= "$t,$GNSS{$key}[0],$GNSS{$key}[1],$GNSS{$key}[2],$GNSS{$key}[3],$GNSS{$key}[4]\n";
+			}
 		}
 	}
+	if ($opt_b){
+		# header: magic,version,record size,sequence number,timestamp,record count,reserved
+		$bd = pack("a2CCVVvv","GV",1,8,$seq++,time(),$nrecs,0).$bd;
+	}
 	print "Sending ",length($bd), " bytes\n";
 	$sock->send($bd) || print "Couldn't send\n";
 	%GNSS=();
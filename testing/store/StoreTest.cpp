@@ -0,0 +1,144 @@
+//
+// gnssview - a program for displaying GNSS satellite paths
+//
+// The MIT License (MIT)
+//
+// Copyright (c)  2014  Michael J. Wouters
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Checks that a track file which can't be restored is replaced by an empty store,
+// rather than being used, or crashing the program, and that a file in use isn't opened again
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QFile>
+
+#include "TrackStore.h"
+
+static int nFailed=0;
+
+static void check(bool ok,const char *what)
+{
+	std::cout << (ok ? "  ok     " : "  FAILED ") << what << std::endl;
+	if (!ok) nFailed++;
+}
+
+// A store with one track in it, left in the file
+static void writeStore(const QString &fname)
+{
+	QFile::remove(fname);
+	TrackStore store;
+	store.setLimits(100,0);
+	store.open(fname);
+	int slot = store.allocate();
+	store.setIdentity(slot,1,5);
+	for (int i=0;i<10;i++)
+		store.append(slot,i,45.0,1500000000+i);
+	store.close();
+}
+
+static void patch(const QString &fname,size_t offset,quint32 value)
+{
+	QFile f(fname);
+	f.open(QIODevice::ReadWrite);
+	f.seek(offset);
+	f.write((const char *) &value,sizeof(value));
+	f.close();
+}
+
+// Reopens the file, and checks that it is usable afterwards
+static void reopen(const QString &fname,int points,bool restorable,const char *what)
+{
+	std::cout << what << std::endl;
+	TrackStore store;
+	store.setLimits(points,0);
+	check(store.open(fname),"opened");
+	QList<int> restored = store.takeRestored();
+	if (restorable){
+		check(restored.size() == 1,"one track restored");
+	}
+	else{
+		check(restored.isEmpty(),"nothing restored");
+		check(store.slotsInUse() == 0,"no slots in use");
+	}
+	// enough to grow the store, which remaps the file
+	QList<int> allocated;
+	for (int i=0;i<2*TRACK_INIT_SLOTS;i++){
+		int slot = store.allocate();
+		store.append(slot,10.0,20.0,1500000000);
+		allocated.append(slot);
+	}
+	check(store.slotsInUse() == (restorable ? 1 : 0) + 2*TRACK_INIT_SLOTS,"grown");
+	bool intact=true;
+	for (int i=0;i<allocated.size();i++)
+		intact = intact && store.size(allocated.at(i)) == 1 && store.elev(allocated.at(i),0) == 20.0;
+	check(intact,"new tracks intact");
+	store.close();
+}
+
+// A second store can't open the file while the first has it
+static void locked(const QString &fname)
+{
+	std::cout << "in use" << std::endl;
+	TrackStore first,second;
+	first.setLimits(100,0);
+	second.setLimits(100,0);
+	check(first.open(fname),"opened");
+	check(!second.open(fname),"not opened again");
+	first.close();
+	check(second.open(fname),"opened once closed");
+	check(second.takeRestored().size() == 1,"one track restored");
+}
+
+int main(int argc,char **argv)
+{
+	QCoreApplication a(argc,argv);
+	QString fname = (argc > 1 ? QString(argv[1]) : QString("/tmp/storetest.tracks"));
+	
+	writeStore(fname);
+	reopen(fname,100,true,"intact file");
+	
+	writeStore(fname);
+	patch(fname,offsetof(TrackHeader,version),TRACK_FILE_VERSION+1);
+	reopen(fname,100,false,"wrong version");
+	
+	writeStore(fname);
+	patch(fname,offsetof(TrackHeader,valid),0);
+	reopen(fname,100,false,"left invalid, as by a crash while growing");
+	
+	writeStore(fname);
+	reopen(fname,200,false,"different limits");
+	
+	writeStore(fname);
+	locked(fname);
+	
+	QFile::remove(fname);
+	
+	if (nFailed){
+		std::cout << nFailed << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "all passed" << std::endl;
+	return EXIT_SUCCESS;
+}
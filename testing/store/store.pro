@@ -0,0 +1,18 @@
+# Checks of the track store's file handling
+#
+#	qmake store.pro
+#	make
+#	./storetest
+
+TEMPLATE      = app
+TARGET        = storetest
+INCLUDEPATH  += ../..
+HEADERS       = ../../TrackStore.h
+SOURCES       = StoreTest.cpp \
+								../../TrackStore.cpp
+QT           += core
+QT           -= gui
+
+CONFIG       += console
+CONFIG       -= app_bundle
+DEFINES      += QT_NO_DEBUG_OUTPUT
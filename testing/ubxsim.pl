@@ -0,0 +1,40 @@
+#!/usr/bin/perl -w
+
+# Simulates a u-blox receiver by writing UBX NAV-SAT messages to stdout, once per second
+# Usage: ubxsim.pl [-n nsats]
+# For example, to present it as a serial port:
+#   socat -d -d pty,raw,echo=0,link=/tmp/ttyUBX EXEC:"./ubxsim.pl"
+# and set the stream path to /tmp/ttyUBX, with format ubx
+use Getopt::Std;
+
+our $opt_n;
+getopts('n:');
+$nsats = ($opt_n ? $opt_n : 24);
+
+$|=1; # unbuffered
+
+# gnssId, svId
+@gnss=([0,1],[0,5],[0,12],[0,17],[0,24],[0,29],[6,3],[6,9],[6,14],[6,20],[2,4],[2,11],
+	[2,19],[2,26],[3,6],[3,14],[3,22],[3,30],[5,1],[5,3],[1,127],[1,133],[0,31],[2,33]);
+if ($nsats > $#gnss+1){$nsats=$#gnss+1;}
+
+$t=0;
+while (1)
+{
+	$payload = pack("VCCv",$t*1000,1,$nsats,0); # iTOW, version, numSvs, reserved
+	for ($i=0;$i<$nsats;$i++){
+		$az = ($i*47 + $t/20) % 360;
+		$el = 5 + int(80*abs(sin($i + $t/3600.0)));
+		# gnssId,svId,cno,elev,azim,prRes,flags (orbit source = ephemeris)
+		$payload .= pack("CCCcs<s<V",$gnss[$i][0],$gnss[$i][1],30+$i%20,$el,$az,0,0x100);
+	}
+	$msg = pack("CCv",0x01,0x35,length($payload)).$payload;
+	$a=$b=0;
+	foreach $c (unpack("C*",$msg)){
+		$a = ($a + $c) & 0xff;
+		$b = ($b + $a) & 0xff;
+	}
+	print pack("CC",0xb5,0x62).$msg.pack("CC",$a,$b);
+	$t++;
+	sleep(1);
+}